@@ -0,0 +1,40 @@
+#include "breakpoints.h"
+
+namespace emulator {
+
+void breakpoint_set::set(break_kind kind, uint16_t address, break_condition condition)
+{
+    if (condition)
+        conditions[key(kind, address)] = std::move(condition);
+    else
+        conditions.erase(key(kind, address));
+
+    if (contains(kind, address))
+        return;
+
+    bits[index(kind)][address >> 6] |= uint64_t { 1 } << (address & 63);
+    per_page[index(kind)][address >> 8]++;
+    counts[index(kind)]++;
+}
+
+void breakpoint_set::clear(break_kind kind, uint16_t address)
+{
+    if (!contains(kind, address))
+        return;
+
+    bits[index(kind)][address >> 6] &= ~(uint64_t { 1 } << (address & 63));
+    per_page[index(kind)][address >> 8]--;
+    counts[index(kind)]--;
+    conditions.erase(key(kind, address));
+}
+
+bool breakpoint_set::hit(break_kind kind, uint16_t address) const
+{
+    if (!contains(kind, address))
+        return false;
+
+    const auto condition = conditions.find(key(kind, address));
+    return condition == conditions.end() || condition->second();
+}
+
+}
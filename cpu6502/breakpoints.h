@@ -0,0 +1,45 @@
+#pragma once
+
+#include "types.h"
+
+namespace emulator {
+
+enum class break_kind : uint8_t {
+    execute, // PC reaches the address
+    read, // a data read, opcode and operand fetches don't count
+    write
+};
+
+// asked only when the address is hit, a hit it turns down doesn't count
+using break_condition = std::function<bool()>;
+
+// breakpoints of every kind as one bit per address, see basic_cpu6502::set_breakpoint,
+// testing an address is a bit test, a condition is looked up only once its bit is set
+class breakpoint_set {
+public:
+    // setting one again replaces its condition
+    void set(break_kind kind, uint16_t address, break_condition condition);
+    void clear(break_kind kind, uint16_t address);
+
+    bool contains(break_kind kind, uint16_t address) const
+    {
+        return bits[index(kind)][address >> 6] >> (address & 63) & 1;
+    }
+
+    // set and its condition agrees, kept out of line so the callers' fast paths stay small
+    bool hit(break_kind kind, uint16_t address) const;
+
+    size_t count(break_kind kind) const { return counts[index(kind)]; }
+    size_t count(break_kind kind, uint8_t page) const { return per_page[index(kind)][page]; }
+
+private:
+    static size_t index(break_kind kind) { return static_cast<size_t>(kind); }
+    static uint32_t key(break_kind kind, uint16_t address) { return (static_cast<uint32_t>(kind) << 16) | address; }
+
+    std::array<std::array<uint64_t, 1024>, 3> bits {};
+    std::array<std::array<uint16_t, 256>, 3> per_page {};
+    std::array<size_t, 3> counts {};
+    std::map<uint32_t, break_condition> conditions; // keyed by kind and address
+};
+
+}
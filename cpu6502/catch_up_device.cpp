@@ -0,0 +1,37 @@
+#include "catch_up_device.h"
+
+namespace emulator {
+
+catch_up_device::catch_up_device(cycle_source cycles)
+    : cycles(std::move(cycles))
+    , synced(this->cycles())
+{
+}
+
+uint8_t catch_up_device::read(uint16_t address)
+{
+    sync();
+    return read_register(address);
+}
+
+void catch_up_device::write(uint16_t address, uint8_t byte)
+{
+    sync();
+    write_register(address, byte);
+}
+
+void catch_up_device::sync()
+{
+    // nothing passed, or the clock was reset and time starts over from here
+    const size_t now = cycles();
+    if (now <= synced) {
+        synced = now;
+        return;
+    }
+
+    const size_t elapsed = now - synced;
+    synced = now;
+    advance(elapsed);
+}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "types.h"
+#include "i_device.h"
+
+namespace emulator {
+
+// devices that sleep between accesses instead of ticking on every cycle, each read and write first
+// advances the device in one step by the cycles passed since it last synced,
+// a scheduled event calls sync as well when the device has to raise an interrupt on time
+class catch_up_device : public i_device {
+public:
+    using cycle_source = std::function<size_t()>; // usually basic_cpu6502::get_cycles
+
+    uint8_t read(uint16_t address) final;
+    void write(uint16_t address, uint8_t byte) final;
+
+    void sync();
+    size_t get_synced() const { return synced; }
+
+protected:
+    explicit catch_up_device(cycle_source cycles);
+
+    virtual void advance(size_t cycles) = 0;
+    virtual uint8_t read_register(uint16_t address) = 0;
+    virtual void write_register(uint16_t address, uint8_t byte) = 0;
+
+private:
+    cycle_source cycles;
+    size_t synced {};
+};
+
+}
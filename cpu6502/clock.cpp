@@ -13,11 +13,22 @@ void clock::cycle()
     cycles++;
 }
 
+void clock::add_cycles(size_t count)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(timing * count));
+    cycles += count;
+}
+
 size_t clock::get_cycles()
 {
     return cycles;
 }
 
+void clock::set_cycles(size_t count)
+{
+    cycles = count;
+}
+
 void clock::set_timing(size_t t)
 {
     timing = t;
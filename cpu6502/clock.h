@@ -5,11 +5,13 @@
 
 namespace emulator {
 
-class clock : public i_clock {
+class clock final : public i_clock {
 public:
     void reset() override;
     void cycle() override;
+    void add_cycles(size_t count) override;
     size_t get_cycles() override;
+    void set_cycles(size_t count) override;
     void set_timing(size_t) override;
 
     ~clock() override = default;
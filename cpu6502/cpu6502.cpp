@@ -1,73 +1,219 @@
 #include "cpu6502.h"
+#include "clock.h"
+#include "memory64k.h"
+#include "paged_bus.h"
+#include "realtime_clock.h"
 
 namespace emulator {
 
-cpu6502::cpu6502(i_clock& clock, i_bus& bus)
+template <bus_type Bus, clock_type Clock>
+basic_cpu6502<Bus, Clock>::basic_cpu6502(Clock& clock, Bus& bus)
     : clock(clock)
     , bus(bus)
 {
+    if constexpr (remap_hook<Bus>)
+        bus.on_remap = [this](uint8_t first, size_t count) { remap_pages(first, count); };
 }
 
-void cpu6502::log(bool show)
+template <bus_type Bus, clock_type Clock>
+basic_cpu6502<Bus, Clock>::~basic_cpu6502()
 {
-    if (!show)
-        return;
+    if constexpr (remap_hook<Bus>)
+        bus.on_remap = nullptr;
+}
 
-    static size_t last_cycle {};
-    std::string cycle = (clock.get_cycles() == last_cycle)
-        ? std::string(std::to_string(clock.get_cycles()).size(), '-')
-        : std::to_string(clock.get_cycles());
+template <bus_type Bus, clock_type Clock>
+cpu6502_base::run_result basic_cpu6502<Bus, Clock>::run(const stop_conditions& conditions, const size_t& deadline) noexcept
+{
+    const uint16_t stop = conditions.address;
+    const size_t start = clock.get_cycles();
+    const size_t budget = conditions.cycles < no_deadline - start ? start + conditions.cycles : no_deadline;
+    size_t limit = std::min(deadline, budget);
+    size_t instructions = conditions.instructions;
+    std::optional<stop_reason> reason;
+    uint16_t pc = PC;
+
+    load_flags();
+    flags_unpacked = true;
+
+    const bool breaking = breakpoints && breakpoints->count(break_kind::execute);
+    resume_pc = PC;
+    resuming = true;
+
+    if (block_cache && address != stop && instructions == unlimited && !trace) {
+        const bool native = jit && mode == execution_mode::instruction_accurate
+            && !(breakpoints && breakpoints->count(break_kind::read));
+        const bool checked = conditions.trap || conditions.brk;
+        stop_address = stop;
+        if (native && stop != jit_stop) {
+            jit->flush();
+            drop_blocks();
+            jit_stop = stop;
+        }
+        if constexpr (dirty_tracking<Bus>) {
+            if (native && bus.get_marks() != clean_marks)
+                watch_clean_pages();
+        }
 
-    std::stringstream ss;
-    ss << "oc: " << instructions.at(oc).name
-       << " cycle: " << cycle
-       << " r/w: " << control
-       << " address: " << std::format("{:#06x}", address)
-       << " data: " << std::format("{:#04x}", data)
-       << " A: " << std::format("{:#04x}", A)
-       << " X: " << std::format("{:#04x}", X)
-       << " Y: " << std::format("{:#04x}", Y)
-       << " S: " << std::format("{:#04x}", S)
-       << " NV_BDIZC: "
-       << std::to_string(P.N)
-       << std::to_string(P.V)
-       << std::to_string(P._)
-       << std::to_string(P.B)
-       << std::to_string(P.D)
-       << std::to_string(P.I)
-       << std::to_string(P.Z)
-       << std::to_string(P.C)
-       << " PC: " << std::format("{:#06x}", PC)
-       << "\n";
+        block_t* block = &lookup_block(PC);
+        while (true) {
+            if (interrupts.pending) [[unlikely]] {
+                if (is_halted()) {
+                    reason = stop_reason::jam;
+                    break;
+                }
+                if (interrupts.pending & interrupt_lines::pending_watch) {
+                    reason = take_watch(pc);
+                    break;
+                }
+                limit = std::min(deadline, budget);
+                if (poll_interrupts()) {
+                    if (address == stop)
+                        break;
+                    block = &lookup_block(PC);
+                }
+            }
+
+            // the rest of the slice goes one instruction at a time, as does code on a device page
+            if (!block->size || (limit != no_deadline && clock.get_cycles() + block->max_cycles > limit))
+                break;
+
+            if (breaking && at_breakpoint()) [[unlikely]] {
+                reason = stop_reason::breakpoint;
+                break;
+            }
+
+            if (native && !block->native && block->hits < jit_threshold && ++block->hits == jit_threshold)
+                translate(*block, stop);
+
+            // a breakpoint on the loop has to see every pass
+            const bool idle = block->idle && limit != no_deadline && mode == execution_mode::instruction_accurate
+                && !(breaking && is_execute_breakpoint(block->start));
+            const idle_state_t before = idle ? idle_state() : idle_state_t {};
+
+            const bool running = native && block->native
+                ? execute_native(*block, stop)
+                : execute_block(*block, stop);
+            if (!running)
+                break;
+
+            if (checked) [[unlikely]] {
+                reason = check_block(*block, conditions, pc);
+                if (reason)
+                    break;
+            }
+
+            if (idle && PC == block->start && !interrupts.pending) [[unlikely]]
+                skip_idle(*block, before, limit);
+
+            block = &successor(*block);
+        }
+    }
+
+    const bool checked = conditions.trap || conditions.brk || instructions != unlimited || breaking || trace;
+    while (!reason && address != stop && (limit == no_deadline || clock.get_cycles() < limit)) {
+        if (interrupts.pending) [[unlikely]] {
+            if (is_halted()) {
+                reason = stop_reason::jam;
+                break;
+            }
+            if (interrupts.pending & interrupt_lines::pending_watch) {
+                reason = take_watch(pc);
+                break;
+            }
+            limit = std::min(deadline, budget);
+            if (poll_interrupts())
+                continue;
+        }
+
+        if (checked) [[unlikely]]
+            reason = checked_step(conditions, instructions, pc);
+        else
+            step();
+    }
+    store_flags();
+    flags_unpacked = false;
+
+    if (address == stop) {
+        reason = stop_reason::address;
+    } else if (!reason && (interrupts.pending & interrupt_lines::pending_watch)) {
+        reason = take_watch(pc); // the last instruction of the run hit it
+    } else if (!reason) {
+        reason = budget <= deadline ? stop_reason::cycles : stop_reason::deadline;
+    }
+    if (reason != stop_reason::trap && reason != stop_reason::brk
+        && reason != stop_reason::read_watch && reason != stop_reason::write_watch)
+        pc = PC;
 
-    last_cycle = clock.get_cycles();
-    std::printf(ss.str().c_str());
+    return { *reason, pc, clock.get_cycles() - start };
 }
 
-void cpu6502::run(uint16_t stop)
+template <bus_type Bus, clock_type Clock>
+std::optional<cpu6502_base::stop_reason> basic_cpu6502<Bus, Clock>::check_block(const block_t& block, const stop_conditions& conditions, uint16_t& pc)
 {
-    while (address != stop) {
-        execute();
+    if (conditions.trap && block.trap && PC == block.end - block.trap) {
+        pc = PC;
+        return stop_reason::trap;
+    }
+
+    // BRK always ends a block, the interpreter ran it when it is the last opcode seen
+    if (conditions.brk && oc == BRK____ && block.ops[block.size - 1].oc == BRK____) {
+        pc = block.end - dispatch[BRK____].length;
+        return stop_reason::brk;
     }
-    log(true);
+
+    return std::nullopt;
 }
 
-void cpu6502::cycle()
+template <bus_type Bus, clock_type Clock>
+std::optional<cpu6502_base::stop_reason> basic_cpu6502<Bus, Clock>::checked_step(const stop_conditions& conditions, size_t& instructions, uint16_t& pc)
 {
+    if (instructions == 0)
+        return stop_reason::instructions;
+    if (breakpoints && at_breakpoint())
+        return stop_reason::breakpoint;
+
+    pc = PC;
+    step();
+    if (instructions != unlimited)
+        instructions--;
+
+    if (trace)
+        trace->push(trace_state(pc));
+
+    if (conditions.brk && oc == BRK____)
+        return stop_reason::brk;
+    // JAM leaves PC on itself too, the run loop reports the halt
+    if (conditions.trap && PC == pc && !is_halted())
+        return stop_reason::trap;
+    return std::nullopt;
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::cycle()
+{
+    if (mode == execution_mode::instruction_accurate)
+        return;
+
     clock.cycle();
-    log(false);
 }
 
-uint8_t cpu6502::read()
+template <bus_type Bus, clock_type Clock>
+uint8_t basic_cpu6502<Bus, Clock>::read()
 {
     control = true;
     data = bus.read(address);
+    if (page_flags[address >> 8] & page_read_watch) [[unlikely]]
+        watched(break_kind::read);
     return data;
 }
 
-void cpu6502::write()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::write()
 {
     control = false;
+    if (page_flags[address >> 8])
+        flagged_write();
     bus.write(address, data);
 }
 
@@ -101,35 +247,1274 @@ static uint16_t stack_address(uint8_t S)
     return 0x0100 + S;
 }
 
-static uint8_t status_byte(cpu6502::status P)
+static uint8_t status_byte(cpu6502_base::status P)
 {
     return std::bit_cast<uint8_t>(P);
 }
 
-static cpu6502::status status_byte(uint8_t byte)
+static cpu6502_base::status status_byte(uint8_t byte)
 {
-    auto status = std::bit_cast<cpu6502::status>(byte);
+    auto status = std::bit_cast<cpu6502_base::status>(byte);
     status.B = 1;
     status._ = 1;
     return status;
 }
 
-void cpu6502::execute()
+const std::array<std::string_view, 256> cpu6502_base::mnemonics { {
+    "BRK", "ORA", "x02", "x03", "x04", "ORA", "ASL", "x07", // 0x00
+    "PHP", "ORA", "ASL", "x0B", "x0C", "ORA", "ASL", "x0F", // 0x08
+    "BPL", "ORA", "x12", "x13", "x14", "ORA", "ASL", "x17", // 0x10
+    "CLC", "ORA", "x1A", "x1B", "x1C", "ORA", "ASL", "x1F", // 0x18
+    "JSR", "AND", "x22", "x23", "BIT", "AND", "ROL", "x27", // 0x20
+    "PLP", "AND", "ROL", "x2B", "BIT", "AND", "ROL", "x2F", // 0x28
+    "BMI", "AND", "x32", "x33", "x34", "AND", "ROL", "x37", // 0x30
+    "SEC", "AND", "x3A", "x3B", "x3C", "AND", "ROL", "x3F", // 0x38
+    "RTI", "EOR", "x42", "x43", "x44", "EOR", "LSR", "x47", // 0x40
+    "PHA", "EOR", "LSR", "x4B", "JMP", "EOR", "LSR", "x4F", // 0x48
+    "BVC", "EOR", "x52", "x53", "x54", "EOR", "LSR", "x57", // 0x50
+    "CLI", "EOR", "x5A", "x5B", "x5C", "EOR", "LSR", "x5F", // 0x58
+    "RTS", "ADC", "x62", "x63", "x64", "ADC", "ROR", "x67", // 0x60
+    "PLA", "ADC", "ROR", "x6B", "JMP", "ADC", "ROR", "x6F", // 0x68
+    "BVS", "ADC", "x72", "x73", "x74", "ADC", "ROR", "x77", // 0x70
+    "SEI", "ADC", "x7A", "x7B", "x7C", "ADC", "ROR", "x7F", // 0x78
+    "x80", "STA", "x82", "x83", "STY", "STA", "STX", "x87", // 0x80
+    "DEY", "x89", "TXA", "x8B", "STY", "STA", "STX", "x8F", // 0x88
+    "BCC", "STA", "x92", "x93", "STY", "STA", "STX", "x97", // 0x90
+    "TYA", "STA", "TXS", "x9B", "x9C", "STA", "x9E", "x9F", // 0x98
+    "LDY", "LDA", "LDX", "xA3", "LDY", "LDA", "LDX", "xA7", // 0xA0
+    "TAY", "LDA", "TAX", "xAB", "LDY", "LDA", "LDX", "xAF", // 0xA8
+    "BCS", "LDA", "xB2", "xB3", "LDY", "LDA", "LDX", "xB7", // 0xB0
+    "CLV", "LDA", "TSX", "xBB", "LDY", "LDA", "LDX", "xBF", // 0xB8
+    "CPY", "CMP", "xC2", "xC3", "CPY", "CMP", "DEC", "xC7", // 0xC0
+    "INY", "CMP", "DEX", "xCB", "CPY", "CMP", "DEC", "xCF", // 0xC8
+    "BNE", "CMP", "xD2", "xD3", "xD4", "CMP", "DEC", "xD7", // 0xD0
+    "CLD", "CMP", "xDA", "xDB", "xDC", "CMP", "DEC", "xDF", // 0xD8
+    "CPX", "SBC", "xE2", "xE3", "CPX", "SBC", "INC", "xE7", // 0xE0
+    "INX", "SBC", "NOP", "xEB", "CPX", "SBC", "INC", "xEF", // 0xE8
+    "BEQ", "SBC", "xF2", "xF3", "xF4", "SBC", "INC", "xF7", // 0xF0
+    "SED", "SBC", "xFA", "xFB", "xFC", "SBC", "INC", "xFF", // 0xF8
+} };
+
+template <bus_type Bus, clock_type Clock>
+constexpr std::array<typename basic_cpu6502<Bus, Clock>::instruction_t, 256> basic_cpu6502<Bus, Clock>::instructions { {
+    { BRK____, &basic_cpu6502::BRK, &basic_cpu6502::___, 7 }, // 0x00
+    { ORA_IDX, &basic_cpu6502::ORA, &basic_cpu6502::IDX, 6 }, // 0x01
+    { _0x02__, &basic_cpu6502::JAM, &basic_cpu6502::___, 1 }, // 0x02
+    { _0x03__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x03
+    { _0x04__, &basic_cpu6502::SKP, &basic_cpu6502::ZPG, 3 }, // 0x04
+    { ORA_ZPG, &basic_cpu6502::ORA, &basic_cpu6502::ZPG, 3 }, // 0x05
+    { ASL_ZPG, &basic_cpu6502::ASL, &basic_cpu6502::ZPG, 5 }, // 0x06
+    { _0x07__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x07
+    { PHP_IMP, &basic_cpu6502::PHP, &basic_cpu6502::IMP, 3 }, // 0x08
+    { ORA_IMM, &basic_cpu6502::ORA, &basic_cpu6502::IMM, 2 }, // 0x09
+    { ASL_ACC, &basic_cpu6502::ASL, &basic_cpu6502::ACC, 2 }, // 0x0A
+    { _0x0B__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x0B
+    { _0x0C__, &basic_cpu6502::SKP, &basic_cpu6502::ABS, 4 }, // 0x0C
+    { ORA_ABS, &basic_cpu6502::ORA, &basic_cpu6502::ABS, 4 }, // 0x0D
+    { ASL_ABS, &basic_cpu6502::ASL, &basic_cpu6502::ABS, 6 }, // 0x0E
+    { _0x0F__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x0F
+    { BPL____, &basic_cpu6502::BPL, &basic_cpu6502::___, 2 }, // 0x10
+    { ORA_IDY, &basic_cpu6502::ORA, &basic_cpu6502::IDY, 5 }, // 0x11
+    { _0x12__, &basic_cpu6502::JAM, &basic_cpu6502::___, 1 }, // 0x12
+    { _0x13__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x13
+    { _0x14__, &basic_cpu6502::SKP, &basic_cpu6502::ZPX, 4 }, // 0x14
+    { ORA_ZPX, &basic_cpu6502::ORA, &basic_cpu6502::ZPX, 4 }, // 0x15
+    { ASL_ZPX, &basic_cpu6502::ASL, &basic_cpu6502::ZPX, 6 }, // 0x16
+    { _0x17__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x17
+    { CLC_IMP, &basic_cpu6502::CLC, &basic_cpu6502::IMP, 2 }, // 0x18
+    { ORA_ABY, &basic_cpu6502::ORA, &basic_cpu6502::ABY, 4 }, // 0x19
+    { _0x1A__, &basic_cpu6502::NOP, &basic_cpu6502::IMP, 2 }, // 0x1A
+    { _0x1B__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x1B
+    { _0x1C__, &basic_cpu6502::SKP, &basic_cpu6502::ABX, 4 }, // 0x1C
+    { ORA_ABX, &basic_cpu6502::ORA, &basic_cpu6502::ABX, 4 }, // 0x1D
+    { ASL_ABX, &basic_cpu6502::ASL, &basic_cpu6502::ABX, 7 }, // 0x1E
+    { _0x1F__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x1F
+    { JSR____, &basic_cpu6502::JSR, &basic_cpu6502::___, 6 }, // 0x20
+    { AND_IDX, &basic_cpu6502::AND, &basic_cpu6502::IDX, 6 }, // 0x21
+    { _0x22__, &basic_cpu6502::JAM, &basic_cpu6502::___, 1 }, // 0x22
+    { _0x23__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x23
+    { BIT_ZPG, &basic_cpu6502::BIT, &basic_cpu6502::ZPG, 3 }, // 0x24
+    { AND_ZPG, &basic_cpu6502::AND, &basic_cpu6502::ZPG, 3 }, // 0x25
+    { ROL_ZPG, &basic_cpu6502::ROL, &basic_cpu6502::ZPG, 5 }, // 0x26
+    { _0x27__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x27
+    { PLP_IMP, &basic_cpu6502::PLP, &basic_cpu6502::IMP, 4 }, // 0x28
+    { AND_IMM, &basic_cpu6502::AND, &basic_cpu6502::IMM, 2 }, // 0x29
+    { ROL_ACC, &basic_cpu6502::ROL, &basic_cpu6502::ACC, 2 }, // 0x2A
+    { _0x2B__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x2B
+    { BIT_ABS, &basic_cpu6502::BIT, &basic_cpu6502::ABS, 4 }, // 0x2C
+    { AND_ABS, &basic_cpu6502::AND, &basic_cpu6502::ABS, 4 }, // 0x2D
+    { ROL_ABS, &basic_cpu6502::ROL, &basic_cpu6502::ABS, 6 }, // 0x2E
+    { _0x2F__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x2F
+    { BMI____, &basic_cpu6502::BMI, &basic_cpu6502::___, 2 }, // 0x30
+    { AND_IDY, &basic_cpu6502::AND, &basic_cpu6502::IDY, 5 }, // 0x31
+    { _0x32__, &basic_cpu6502::JAM, &basic_cpu6502::___, 1 }, // 0x32
+    { _0x33__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x33
+    { _0x34__, &basic_cpu6502::SKP, &basic_cpu6502::ZPX, 4 }, // 0x34
+    { AND_ZPX, &basic_cpu6502::AND, &basic_cpu6502::ZPX, 4 }, // 0x35
+    { ROL_ZPX, &basic_cpu6502::ROL, &basic_cpu6502::ZPX, 6 }, // 0x36
+    { _0x37__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x37
+    { SEC_IMP, &basic_cpu6502::SEC, &basic_cpu6502::IMP, 2 }, // 0x38
+    { AND_ABY, &basic_cpu6502::AND, &basic_cpu6502::ABY, 4 }, // 0x39
+    { _0x3A__, &basic_cpu6502::NOP, &basic_cpu6502::IMP, 2 }, // 0x3A
+    { _0x3B__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x3B
+    { _0x3C__, &basic_cpu6502::SKP, &basic_cpu6502::ABX, 4 }, // 0x3C
+    { AND_ABX, &basic_cpu6502::AND, &basic_cpu6502::ABX, 4 }, // 0x3D
+    { ROL_ABX, &basic_cpu6502::ROL, &basic_cpu6502::ABX, 7 }, // 0x3E
+    { _0x3F__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x3F
+    { RTI_IMP, &basic_cpu6502::RTI, &basic_cpu6502::IMP, 6 }, // 0x40
+    { EOR_IDX, &basic_cpu6502::EOR, &basic_cpu6502::IDX, 6 }, // 0x41
+    { _0x42__, &basic_cpu6502::JAM, &basic_cpu6502::___, 1 }, // 0x42
+    { _0x43__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x43
+    { _0x44__, &basic_cpu6502::SKP, &basic_cpu6502::ZPG, 3 }, // 0x44
+    { EOR_ZPG, &basic_cpu6502::EOR, &basic_cpu6502::ZPG, 3 }, // 0x45
+    { LSR_ZPG, &basic_cpu6502::LSR, &basic_cpu6502::ZPG, 5 }, // 0x46
+    { _0x47__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x47
+    { PHA_IMP, &basic_cpu6502::PHA, &basic_cpu6502::IMP, 3 }, // 0x48
+    { EOR_IMM, &basic_cpu6502::EOR, &basic_cpu6502::IMM, 2 }, // 0x49
+    { LSR_ACC, &basic_cpu6502::LSR, &basic_cpu6502::ACC, 2 }, // 0x4A
+    { _0x4B__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x4B
+    { JMP_ABS, &basic_cpu6502::JMP, &basic_cpu6502::ABS, 3 }, // 0x4C
+    { EOR_ABS, &basic_cpu6502::EOR, &basic_cpu6502::ABS, 4 }, // 0x4D
+    { LSR_ABS, &basic_cpu6502::LSR, &basic_cpu6502::ABS, 6 }, // 0x4E
+    { _0x4F__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x4F
+    { BVC____, &basic_cpu6502::BVC, &basic_cpu6502::___, 2 }, // 0x50
+    { EOR_IDY, &basic_cpu6502::EOR, &basic_cpu6502::IDY, 5 }, // 0x51
+    { _0x52__, &basic_cpu6502::JAM, &basic_cpu6502::___, 1 }, // 0x52
+    { _0x53__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x53
+    { _0x54__, &basic_cpu6502::SKP, &basic_cpu6502::ZPX, 4 }, // 0x54
+    { EOR_ZPX, &basic_cpu6502::EOR, &basic_cpu6502::ZPX, 4 }, // 0x55
+    { LSR_ZPX, &basic_cpu6502::LSR, &basic_cpu6502::ZPX, 6 }, // 0x56
+    { _0x57__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x57
+    { CLI_IMP, &basic_cpu6502::CLI, &basic_cpu6502::IMP, 2 }, // 0x58
+    { EOR_ABY, &basic_cpu6502::EOR, &basic_cpu6502::ABY, 4 }, // 0x59
+    { _0x5A__, &basic_cpu6502::NOP, &basic_cpu6502::IMP, 2 }, // 0x5A
+    { _0x5B__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x5B
+    { _0x5C__, &basic_cpu6502::SKP, &basic_cpu6502::ABX, 4 }, // 0x5C
+    { EOR_ABX, &basic_cpu6502::EOR, &basic_cpu6502::ABX, 4 }, // 0x5D
+    { LSR_ABX, &basic_cpu6502::LSR, &basic_cpu6502::ABX, 7 }, // 0x5E
+    { _0x5F__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x5F
+    { RTS_IMP, &basic_cpu6502::RTS, &basic_cpu6502::IMP, 6 }, // 0x60
+    { ADC_IDX, &basic_cpu6502::ADC, &basic_cpu6502::IDX, 6 }, // 0x61
+    { _0x62__, &basic_cpu6502::JAM, &basic_cpu6502::___, 1 }, // 0x62
+    { _0x63__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x63
+    { _0x64__, &basic_cpu6502::SKP, &basic_cpu6502::ZPG, 3 }, // 0x64
+    { ADC_ZPG, &basic_cpu6502::ADC, &basic_cpu6502::ZPG, 3 }, // 0x65
+    { ROR_ZPG, &basic_cpu6502::ROR, &basic_cpu6502::ZPG, 5 }, // 0x66
+    { _0x67__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x67
+    { PLA_IMP, &basic_cpu6502::PLA, &basic_cpu6502::IMP, 4 }, // 0x68
+    { ADC_IMM, &basic_cpu6502::ADC, &basic_cpu6502::IMM, 2 }, // 0x69
+    { ROR_ACC, &basic_cpu6502::ROR, &basic_cpu6502::ACC, 2 }, // 0x6A
+    { _0x6B__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x6B
+    { JMP_IND, &basic_cpu6502::JMP, &basic_cpu6502::IND, 5 }, // 0x6C
+    { ADC_ABS, &basic_cpu6502::ADC, &basic_cpu6502::ABS, 4 }, // 0x6D
+    { ROR_ABS, &basic_cpu6502::ROR, &basic_cpu6502::ABS, 6 }, // 0x6E
+    { _0x6F__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x6F
+    { BVS____, &basic_cpu6502::BVS, &basic_cpu6502::___, 2 }, // 0x70
+    { ADC_IDY, &basic_cpu6502::ADC, &basic_cpu6502::IDY, 5 }, // 0x71
+    { _0x72__, &basic_cpu6502::JAM, &basic_cpu6502::___, 1 }, // 0x72
+    { _0x73__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x73
+    { _0x74__, &basic_cpu6502::SKP, &basic_cpu6502::ZPX, 4 }, // 0x74
+    { ADC_ZPX, &basic_cpu6502::ADC, &basic_cpu6502::ZPX, 4 }, // 0x75
+    { ROR_ZPX, &basic_cpu6502::ROR, &basic_cpu6502::ZPX, 6 }, // 0x76
+    { _0x77__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x77
+    { SEI_IMP, &basic_cpu6502::SEI, &basic_cpu6502::IMP, 2 }, // 0x78
+    { ADC_ABY, &basic_cpu6502::ADC, &basic_cpu6502::ABY, 4 }, // 0x79
+    { _0x7A__, &basic_cpu6502::NOP, &basic_cpu6502::IMP, 2 }, // 0x7A
+    { _0x7B__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x7B
+    { _0x7C__, &basic_cpu6502::SKP, &basic_cpu6502::ABX, 4 }, // 0x7C
+    { ADC_ABX, &basic_cpu6502::ADC, &basic_cpu6502::ABX, 4 }, // 0x7D
+    { ROR_ABX, &basic_cpu6502::ROR, &basic_cpu6502::ABX, 7 }, // 0x7E
+    { _0x7F__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x7F
+    { _0x80__, &basic_cpu6502::SKP, &basic_cpu6502::IMM, 2 }, // 0x80
+    { STA_IDX, &basic_cpu6502::STA, &basic_cpu6502::IDX, 6 }, // 0x81
+    { _0x82__, &basic_cpu6502::SKP, &basic_cpu6502::IMM, 2 }, // 0x82
+    { _0x83__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x83
+    { STY_ZPG, &basic_cpu6502::STY, &basic_cpu6502::ZPG, 3 }, // 0x84
+    { STA_ZPG, &basic_cpu6502::STA, &basic_cpu6502::ZPG, 3 }, // 0x85
+    { STX_ZPG, &basic_cpu6502::STX, &basic_cpu6502::ZPG, 3 }, // 0x86
+    { _0x87__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x87
+    { DEY_IMP, &basic_cpu6502::DEY, &basic_cpu6502::IMP, 2 }, // 0x88
+    { _0x89__, &basic_cpu6502::SKP, &basic_cpu6502::IMM, 2 }, // 0x89
+    { TXA_IMP, &basic_cpu6502::TXA, &basic_cpu6502::IMP, 2 }, // 0x8A
+    { _0x8B__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x8B
+    { STY_ABS, &basic_cpu6502::STY, &basic_cpu6502::ABS, 4 }, // 0x8C
+    { STA_ABS, &basic_cpu6502::STA, &basic_cpu6502::ABS, 4 }, // 0x8D
+    { STX_ABS, &basic_cpu6502::STX, &basic_cpu6502::ABS, 4 }, // 0x8E
+    { _0x8F__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x8F
+    { BCC____, &basic_cpu6502::BCC, &basic_cpu6502::___, 2 }, // 0x90
+    { STA_IDY, &basic_cpu6502::STA, &basic_cpu6502::IDY, 6 }, // 0x91
+    { _0x92__, &basic_cpu6502::JAM, &basic_cpu6502::___, 1 }, // 0x92
+    { _0x93__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x93
+    { STY_ZPX, &basic_cpu6502::STY, &basic_cpu6502::ZPX, 4 }, // 0x94
+    { STA_ZPX, &basic_cpu6502::STA, &basic_cpu6502::ZPX, 4 }, // 0x95
+    { STX_ZPY, &basic_cpu6502::STX, &basic_cpu6502::ZPY, 4 }, // 0x96
+    { _0x97__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x97
+    { TYA_IMP, &basic_cpu6502::TYA, &basic_cpu6502::IMP, 2 }, // 0x98
+    { STA_ABY, &basic_cpu6502::STA, &basic_cpu6502::ABY, 5 }, // 0x99
+    { TXS_IMP, &basic_cpu6502::TXS, &basic_cpu6502::IMP, 2 }, // 0x9A
+    { _0x9B__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x9B
+    { _0x9C__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x9C
+    { STA_ABX, &basic_cpu6502::STA, &basic_cpu6502::ABX, 5 }, // 0x9D
+    { _0x9E__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x9E
+    { _0x9F__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0x9F
+    { LDY_IMM, &basic_cpu6502::LDY, &basic_cpu6502::IMM, 2 }, // 0xA0
+    { LDA_IDX, &basic_cpu6502::LDA, &basic_cpu6502::IDX, 6 }, // 0xA1
+    { LDX_IMM, &basic_cpu6502::LDX, &basic_cpu6502::IMM, 2 }, // 0xA2
+    { _0xA3__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xA3
+    { LDY_ZPG, &basic_cpu6502::LDY, &basic_cpu6502::ZPG, 3 }, // 0xA4
+    { LDA_ZPG, &basic_cpu6502::LDA, &basic_cpu6502::ZPG, 3 }, // 0xA5
+    { LDX_ZPG, &basic_cpu6502::LDX, &basic_cpu6502::ZPG, 3 }, // 0xA6
+    { _0xA7__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xA7
+    { TAY_IMP, &basic_cpu6502::TAY, &basic_cpu6502::IMP, 2 }, // 0xA8
+    { LDA_IMM, &basic_cpu6502::LDA, &basic_cpu6502::IMM, 2 }, // 0xA9
+    { TAX_IMP, &basic_cpu6502::TAX, &basic_cpu6502::IMP, 2 }, // 0xAA
+    { _0xAB__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xAB
+    { LDY_ABS, &basic_cpu6502::LDY, &basic_cpu6502::ABS, 4 }, // 0xAC
+    { LDA_ABS, &basic_cpu6502::LDA, &basic_cpu6502::ABS, 4 }, // 0xAD
+    { LDX_ABS, &basic_cpu6502::LDX, &basic_cpu6502::ABS, 4 }, // 0xAE
+    { _0xAF__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xAF
+    { BCS____, &basic_cpu6502::BCS, &basic_cpu6502::___, 2 }, // 0xB0
+    { LDA_IDY, &basic_cpu6502::LDA, &basic_cpu6502::IDY, 5 }, // 0xB1
+    { _0xB2__, &basic_cpu6502::JAM, &basic_cpu6502::___, 1 }, // 0xB2
+    { _0xB3__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xB3
+    { LDY_ZPX, &basic_cpu6502::LDY, &basic_cpu6502::ZPX, 4 }, // 0xB4
+    { LDA_ZPX, &basic_cpu6502::LDA, &basic_cpu6502::ZPX, 4 }, // 0xB5
+    { LDX_ZPY, &basic_cpu6502::LDX, &basic_cpu6502::ZPY, 4 }, // 0xB6
+    { _0xB7__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xB7
+    { CLV_IMP, &basic_cpu6502::CLV, &basic_cpu6502::IMP, 2 }, // 0xB8
+    { LDA_ABY, &basic_cpu6502::LDA, &basic_cpu6502::ABY, 4 }, // 0xB9
+    { TSX_IMP, &basic_cpu6502::TSX, &basic_cpu6502::IMP, 2 }, // 0xBA
+    { _0xBB__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xBB
+    { LDY_ABX, &basic_cpu6502::LDY, &basic_cpu6502::ABX, 4 }, // 0xBC
+    { LDA_ABX, &basic_cpu6502::LDA, &basic_cpu6502::ABX, 4 }, // 0xBD
+    { LDX_ABY, &basic_cpu6502::LDX, &basic_cpu6502::ABY, 4 }, // 0xBE
+    { _0xBF__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xBF
+    { CPY_IMM, &basic_cpu6502::CPY, &basic_cpu6502::IMM, 2 }, // 0xC0
+    { CMP_IDX, &basic_cpu6502::CMP, &basic_cpu6502::IDX, 6 }, // 0xC1
+    { _0xC2__, &basic_cpu6502::SKP, &basic_cpu6502::IMM, 2 }, // 0xC2
+    { _0xC3__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xC3
+    { CPY_ZPG, &basic_cpu6502::CPY, &basic_cpu6502::ZPG, 3 }, // 0xC4
+    { CMP_ZPG, &basic_cpu6502::CMP, &basic_cpu6502::ZPG, 3 }, // 0xC5
+    { DEC_ZPG, &basic_cpu6502::DEC, &basic_cpu6502::ZPG, 5 }, // 0xC6
+    { _0xC7__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xC7
+    { INY_IMP, &basic_cpu6502::INY, &basic_cpu6502::IMP, 2 }, // 0xC8
+    { CMP_IMM, &basic_cpu6502::CMP, &basic_cpu6502::IMM, 2 }, // 0xC9
+    { DEX_IMP, &basic_cpu6502::DEX, &basic_cpu6502::IMP, 2 }, // 0xCA
+    { _0xCB__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xCB
+    { CPY_ABS, &basic_cpu6502::CPY, &basic_cpu6502::ABS, 4 }, // 0xCC
+    { CMP_ABS, &basic_cpu6502::CMP, &basic_cpu6502::ABS, 4 }, // 0xCD
+    { DEC_ABS, &basic_cpu6502::DEC, &basic_cpu6502::ABS, 6 }, // 0xCE
+    { _0xCF__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xCF
+    { BNE____, &basic_cpu6502::BNE, &basic_cpu6502::___, 2 }, // 0xD0
+    { CMP_IDY, &basic_cpu6502::CMP, &basic_cpu6502::IDY, 5 }, // 0xD1
+    { _0xD2__, &basic_cpu6502::JAM, &basic_cpu6502::___, 1 }, // 0xD2
+    { _0xD3__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xD3
+    { _0xD4__, &basic_cpu6502::SKP, &basic_cpu6502::ZPX, 4 }, // 0xD4
+    { CMP_ZPX, &basic_cpu6502::CMP, &basic_cpu6502::ZPX, 4 }, // 0xD5
+    { DEC_ZPX, &basic_cpu6502::DEC, &basic_cpu6502::ZPX, 6 }, // 0xD6
+    { _0xD7__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xD7
+    { CLD_IMP, &basic_cpu6502::CLD, &basic_cpu6502::IMP, 2 }, // 0xD8
+    { CMP_ABY, &basic_cpu6502::CMP, &basic_cpu6502::ABY, 4 }, // 0xD9
+    { _0xDA__, &basic_cpu6502::NOP, &basic_cpu6502::IMP, 2 }, // 0xDA
+    { _0xDB__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xDB
+    { _0xDC__, &basic_cpu6502::SKP, &basic_cpu6502::ABX, 4 }, // 0xDC
+    { CMP_ABX, &basic_cpu6502::CMP, &basic_cpu6502::ABX, 4 }, // 0xDD
+    { DEC_ABX, &basic_cpu6502::DEC, &basic_cpu6502::ABX, 7 }, // 0xDE
+    { _0xDF__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xDF
+    { CPX_IMM, &basic_cpu6502::CPX, &basic_cpu6502::IMM, 2 }, // 0xE0
+    { SBC_IDX, &basic_cpu6502::SBC, &basic_cpu6502::IDX, 6 }, // 0xE1
+    { _0xE2__, &basic_cpu6502::SKP, &basic_cpu6502::IMM, 2 }, // 0xE2
+    { _0xE3__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xE3
+    { CPX_ZPG, &basic_cpu6502::CPX, &basic_cpu6502::ZPG, 3 }, // 0xE4
+    { SBC_ZPG, &basic_cpu6502::SBC, &basic_cpu6502::ZPG, 3 }, // 0xE5
+    { INC_ZPG, &basic_cpu6502::INC, &basic_cpu6502::ZPG, 5 }, // 0xE6
+    { _0xE7__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xE7
+    { INX_IMP, &basic_cpu6502::INX, &basic_cpu6502::IMP, 2 }, // 0xE8
+    { SBC_IMM, &basic_cpu6502::SBC, &basic_cpu6502::IMM, 2 }, // 0xE9
+    { NOP_IMP, &basic_cpu6502::NOP, &basic_cpu6502::IMP, 2 }, // 0xEA
+    { _0xEB__, &basic_cpu6502::___, &basic_cpu6502::IMP, 2 }, // 0xEB
+    { CPX_ABS, &basic_cpu6502::CPX, &basic_cpu6502::ABS, 4 }, // 0xEC
+    { SBC_ABS, &basic_cpu6502::SBC, &basic_cpu6502::ABS, 4 }, // 0xED
+    { INC_ABS, &basic_cpu6502::INC, &basic_cpu6502::ABS, 6 }, // 0xEE
+    { _0xEF__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xEF
+    { BEQ____, &basic_cpu6502::BEQ, &basic_cpu6502::___, 2 }, // 0xF0
+    { SBC_IDY, &basic_cpu6502::SBC, &basic_cpu6502::IDY, 5 }, // 0xF1
+    { _0xF2__, &basic_cpu6502::JAM, &basic_cpu6502::___, 1 }, // 0xF2
+    { _0xF3__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xF3
+    { _0xF4__, &basic_cpu6502::SKP, &basic_cpu6502::ZPX, 4 }, // 0xF4
+    { SBC_ZPX, &basic_cpu6502::SBC, &basic_cpu6502::ZPX, 4 }, // 0xF5
+    { INC_ZPX, &basic_cpu6502::INC, &basic_cpu6502::ZPX, 6 }, // 0xF6
+    { _0xF7__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xF7
+    { SED_IMP, &basic_cpu6502::SED, &basic_cpu6502::IMP, 2 }, // 0xF8
+    { SBC_ABY, &basic_cpu6502::SBC, &basic_cpu6502::ABY, 4 }, // 0xF9
+    { _0xFA__, &basic_cpu6502::NOP, &basic_cpu6502::IMP, 2 }, // 0xFA
+    { _0xFB__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xFB
+    { _0xFC__, &basic_cpu6502::SKP, &basic_cpu6502::ABX, 4 }, // 0xFC
+    { SBC_ABX, &basic_cpu6502::SBC, &basic_cpu6502::ABX, 4 }, // 0xFD
+    { INC_ABX, &basic_cpu6502::INC, &basic_cpu6502::ABX, 7 }, // 0xFE
+    { _0xFF__, &basic_cpu6502::___, &basic_cpu6502::___, 1 }, // 0xFF
+} };
+
+template <bus_type Bus, clock_type Clock>
+template <void (basic_cpu6502<Bus, Clock>::*addressing)(), void (basic_cpu6502<Bus, Clock>::*operation)()>
+void basic_cpu6502<Bus, Clock>::fused(basic_cpu6502& cpu) noexcept
+{
+    (cpu.*addressing)();
+    (cpu.*operation)();
+}
+
+template <bus_type Bus, clock_type Clock>
+template <size_t... index>
+constexpr std::array<typename basic_cpu6502<Bus, Clock>::dispatch_t, 256> basic_cpu6502<Bus, Clock>::make_dispatch(std::index_sequence<index...>)
+{
+    return { { { &basic_cpu6502::fused<instructions[index].addressing, instructions[index].operation>,
+        static_cast<uint8_t>(instructions[index].cycles),
+        length(instructions[index]),
+        ends_block(instructions[index]),
+        idle_safe(instructions[index]) }... } };
+}
+
+template <bus_type Bus, clock_type Clock>
+constexpr uint8_t basic_cpu6502<Bus, Clock>::length(const instruction_t& instruction)
+{
+    const auto addressing = instruction.addressing;
+    const auto operation = instruction.operation;
+
+    if (addressing == &basic_cpu6502::ABS
+        || addressing == &basic_cpu6502::ABX
+        || addressing == &basic_cpu6502::ABY
+        || addressing == &basic_cpu6502::IND
+        || operation == &basic_cpu6502::JSR)
+        return 3;
+
+    if (addressing == &basic_cpu6502::IMM
+        || addressing == &basic_cpu6502::ZPG
+        || addressing == &basic_cpu6502::ZPX
+        || addressing == &basic_cpu6502::ZPY
+        || addressing == &basic_cpu6502::IDX
+        || addressing == &basic_cpu6502::IDY
+        || operation == &basic_cpu6502::BRK
+        || ends_block(instruction)) // branches
+        return 2;
+
+    return 1;
+}
+
+template <bus_type Bus, clock_type Clock>
+constexpr bool basic_cpu6502<Bus, Clock>::ends_block(const instruction_t& instruction)
+{
+    const auto operation = instruction.operation;
+
+    return operation == &basic_cpu6502::BCC
+        || operation == &basic_cpu6502::BCS
+        || operation == &basic_cpu6502::BNE
+        || operation == &basic_cpu6502::BEQ
+        || operation == &basic_cpu6502::BPL
+        || operation == &basic_cpu6502::BMI
+        || operation == &basic_cpu6502::BVC
+        || operation == &basic_cpu6502::BVS
+        || operation == &basic_cpu6502::JMP
+        || operation == &basic_cpu6502::JSR
+        || operation == &basic_cpu6502::RTS
+        || operation == &basic_cpu6502::RTI
+        || operation == &basic_cpu6502::BRK
+        || operation == &basic_cpu6502::JAM;
+}
+
+template <bus_type Bus, clock_type Clock>
+constexpr bool basic_cpu6502<Bus, Clock>::idle_safe(const instruction_t& instruction)
+{
+    const auto operation = instruction.operation;
+    const auto addressing = instruction.addressing;
+
+    // reads without an index, the address is the same on every pass
+    if (operation == &basic_cpu6502::LDA
+        || operation == &basic_cpu6502::LDX
+        || operation == &basic_cpu6502::LDY
+        || operation == &basic_cpu6502::CMP
+        || operation == &basic_cpu6502::CPX
+        || operation == &basic_cpu6502::CPY
+        || operation == &basic_cpu6502::AND
+        || operation == &basic_cpu6502::ORA
+        || operation == &basic_cpu6502::EOR
+        || operation == &basic_cpu6502::BIT)
+        return addressing == &basic_cpu6502::IMM
+            || addressing == &basic_cpu6502::ZPG
+            || addressing == &basic_cpu6502::ABS;
+
+    // nothing that writes memory or touches the stack or I
+    return operation == &basic_cpu6502::TAX
+        || operation == &basic_cpu6502::TAY
+        || operation == &basic_cpu6502::TXA
+        || operation == &basic_cpu6502::TYA
+        || operation == &basic_cpu6502::TSX
+        || operation == &basic_cpu6502::CLC
+        || operation == &basic_cpu6502::SEC
+        || operation == &basic_cpu6502::CLV
+        || (operation == &basic_cpu6502::NOP && addressing == &basic_cpu6502::IMP)
+        || (operation == &basic_cpu6502::JMP && addressing == &basic_cpu6502::ABS)
+        || (ends_block(instruction) && length(instruction) == 2 && operation != &basic_cpu6502::BRK); // branches
+}
+
+template <bus_type Bus, clock_type Clock>
+const std::array<typename basic_cpu6502<Bus, Clock>::dispatch_t, 256> basic_cpu6502<Bus, Clock>::dispatch = make_dispatch(std::make_index_sequence<256>());
+
+template <bus_type Bus, clock_type Clock>
+template <cpu6502_base::opcode first, cpu6502_base::opcode second>
+void basic_cpu6502<Bus, Clock>::fused_pair(basic_cpu6502& cpu) noexcept
+{
+    // not every addressing mode consumes its operand bytes, so the second half's are cut out up front
+    const uint32_t tail_operand = cpu.operand >> (8 * (length(instructions[first]) - 1));
+    fused<instructions[first].addressing, instructions[first].operation>(cpu);
+
+    if (cpu.address == cpu.stop_address || cpu.code_written || cpu.interrupts.pending) {
+        cpu.pair_split = true;
+        return;
+    }
+
+    cpu.begin_instruction(second);
+    cpu.operand = tail_operand;
+    fused<instructions[second].addressing, instructions[second].operation>(cpu);
+}
+
+// the leading pairs of top_bigrams on loop heavy code
+template <bus_type Bus, clock_type Clock>
+const std::array<typename basic_cpu6502<Bus, Clock>::pair_t, 6> basic_cpu6502<Bus, Clock>::pairs { {
+    { DEX_IMP, BNE____, &basic_cpu6502::fused_pair<DEX_IMP, BNE____> },
+    { DEY_IMP, BNE____, &basic_cpu6502::fused_pair<DEY_IMP, BNE____> },
+    { CMP_IMM, BEQ____, &basic_cpu6502::fused_pair<CMP_IMM, BEQ____> },
+    { CMP_IMM, BNE____, &basic_cpu6502::fused_pair<CMP_IMM, BNE____> },
+    { LDA_ABX, STA_ABY, &basic_cpu6502::fused_pair<LDA_ABX, STA_ABY> },
+    { INC_ZPG, BNE____, &basic_cpu6502::fused_pair<INC_ZPG, BNE____> },
+} };
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::execute() noexcept
+{
+    load_flags();
+    flags_unpacked = true;
+    const uint16_t pc = PC;
+    const bool stepped = !(interrupts.pending && poll_interrupts());
+    if (stepped)
+        step();
+    store_flags();
+    flags_unpacked = false;
+
+    if (trace && stepped)
+        trace->push(trace_state(pc));
+}
+
+template <bus_type Bus, clock_type Clock>
+inline void basic_cpu6502<Bus, Clock>::step() noexcept
 {
-    add_cycle = cpu6502::cycle_mode::never;
+    add_cycle = cycle_mode::never;
     add_carry = false;
     acc_addressing = false;
 
+    // extra_cycles is left at zero between instructions for get_cycles
+    if (const decoded_t* entry = decode_cache ? predecode(PC) : nullptr) {
+        execute_decoded(entry->handler, entry->operand, entry->oc);
+
+        if (mode == execution_mode::instruction_accurate)
+            clock.add_cycles(entry->cycles + extra_cycles);
+        extra_cycles = 0;
+
+        return;
+    }
+
     address = PC;
     PC++;
-    oc = read();
+    oc = read_code();
     cycle();
 
-    instructions[oc].addressing(*this);
-    instructions[oc].operation(*this);
+    if (bigrams) [[unlikely]]
+        count_bigram(oc);
+
+    dispatch[oc].handler(*this);
+
+    if (mode == execution_mode::instruction_accurate)
+        clock.add_cycles(dispatch[oc].cycles + extra_cycles);
+    extra_cycles = 0;
+}
+
+template <bus_type Bus, clock_type Clock>
+cpu6502_base::cpu_state basic_cpu6502<Bus, Clock>::save()
+{
+    return { clock.get_cycles(), PC, address, A, X, Y, S, P, oc, data, control, interrupts };
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::restore(const cpu_state& state)
+{
+    clock.set_cycles(state.cycles);
+    PC = state.PC;
+    address = state.address;
+    A = state.A;
+    X = state.X;
+    Y = state.Y;
+    S = state.S;
+    P = state.P;
+    oc = state.oc;
+    data = state.data;
+    control = state.control;
+    interrupt_lines::observer* const watcher = interrupts.watcher; // stays with the machine
+    interrupts = state.interrupts;
+    interrupts.watcher = watcher;
+    interrupts.pending &= ~interrupt_lines::pending_watch; // a hit belongs to the run that saw it
+    load_flags();
+
+    if (decode_cache)
+        invalidate_decode_cache();
+}
+
+template <bus_type Bus, clock_type Clock>
+size_t basic_cpu6502<Bus, Clock>::get_cycles()
+{
+    if (mode != execution_mode::instruction_accurate)
+        return clock.get_cycles();
+    return clock.get_cycles() + block_cycles + extra_cycles;
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::load_flags()
+{
+    flags.n = P.N << 7;
+    flags.z = !P.Z;
+    flags.c = P.C;
+    flags.v = P.V;
+
+    if (!(interrupts.pending & interrupt_lines::pending_mask))
+        interrupts.set_masked(P.I);
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::store_flags()
+{
+    P.N = is_negative(flags.n);
+    P.Z = is_zero(flags.z);
+    P.C = flags.c;
+    P.V = flags.v;
+}
+
+template <bus_type Bus, clock_type Clock>
+cpu6502_base::status basic_cpu6502<Bus, Clock>::get_status() const
+{
+    if (!flags_unpacked)
+        return P;
+
+    status current = P;
+    current.N = is_negative(flags.n);
+    current.Z = is_zero(flags.z);
+    current.C = flags.c;
+    current.V = flags.v;
+    return current;
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::begin_instruction(uint8_t next)
+{
+    if (bigrams) [[unlikely]]
+        count_bigram(next);
+
+    add_cycle = cycle_mode::never;
+    add_carry = false;
+    acc_addressing = false;
+
+    address = PC;
+    PC++;
+    control = true;
+    data = next;
+    oc = next;
+    cycle();
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::execute_decoded(handler_t handler, uint32_t bytes, uint8_t next)
+{
+    begin_instruction(next);
+
+    operand = bytes;
+    predecoded = true;
+    handler(*this);
+    predecoded = false;
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::enable_decode_cache(bool enabled)
+{
+    if (!enabled) {
+        jit.reset();
+        block_cache.reset();
+        decode_cache.reset();
+        invalidate_decode_cache();
+        return;
+    }
+
+    if (!decode_cache)
+        decode_cache = std::make_unique<decode_cache_t>();
+    invalidate_decode_cache();
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::invalidate_decode_cache()
+{
+    for (auto& flags : page_flags)
+        flags &= ~page_code;
+
+    if (block_cache)
+        drop_blocks();
+
+    if (decode_cache)
+        decode_cache->generations.fill(next_generation());
+}
+
+template <bus_type Bus, clock_type Clock>
+uint32_t basic_cpu6502<Bus, Clock>::next_generation()
+{
+    // on wraparound every entry is dropped so no stale one can match again
+    if (++cache_generation == 0) {
+        if (decode_cache) {
+            for (auto& entry : decode_cache->entries)
+                entry.generation = 0;
+            decode_cache->generations.fill(1);
+        }
+        cache_generation = 2;
+    }
+    return cache_generation;
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::remap_pages(uint8_t first, size_t count)
+{
+    for (size_t page = first; page < first + count; page++) {
+        if constexpr (ram_bus<Bus>) {
+            if (jit)
+                jit->pages[page] = bus.ram_page(static_cast<uint8_t>(page));
+        }
+
+        if (!(page_flags[page] & page_code))
+            continue;
+
+        // the two entries before the page reach into it
+        decode_cache->generations[page] = next_generation();
+        for (uint16_t pc = static_cast<uint16_t>((page << 8) - 2), i = 0; i < 2; pc++, i++)
+            decode_cache->entries[pc].generation = 0;
+
+        if (block_cache)
+            block_cache->generations[page]++;
+        page_flags[page] &= ~page_code;
+        code_written = true;
+    }
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::enable_block_mode(bool enabled)
+{
+    if (!enabled) {
+        jit.reset();
+        block_cache.reset();
+        return;
+    }
+
+    if (!decode_cache)
+        enable_decode_cache(true);
+    if (!block_cache)
+        block_cache = std::make_unique<block_cache_t>();
+}
+
+template <bus_type Bus, clock_type Clock>
+bool basic_cpu6502<Bus, Clock>::enable_jit(bool enabled)
+{
+    if (!enabled) {
+        // blocks would keep pointing into the released code
+        jit.reset();
+        if (block_cache)
+            drop_blocks();
+        return false;
+    }
+
+    if constexpr (!ram_bus<Bus>) {
+        return false;
+    } else {
+        if (!jit_x64::is_supported())
+            return false;
+
+        enable_block_mode(true);
+        if (!jit) {
+            // remap_pages keeps these current from here on, so scheduler slices don't pay for it
+            jit = std::make_unique<jit_x64>();
+            for (size_t page = 0; page < jit->pages.size(); page++)
+                jit->pages[page] = bus.ram_page(static_cast<uint8_t>(page));
+        }
+        return true;
+    }
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::enable_bigram_profile(bool enabled)
+{
+    if (!enabled) {
+        bigrams.reset();
+        return;
+    }
+
+    if (!bigrams)
+        bigrams = std::make_unique<std::array<uint64_t, 256 * 256>>();
+    bigrams->fill(0);
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::enable_write_journal(bool enabled)
+{
+    if (!enabled) {
+        journal.reset();
+        for (auto& flags : page_flags)
+            flags &= ~page_journal;
+        return;
+    }
+
+    journal = std::make_unique<write_journal>();
+    for (auto& flags : page_flags)
+        flags |= page_journal;
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::enable_trace(bool enabled, size_t records)
+{
+    if (!enabled) {
+        trace.reset();
+        return;
+    }
+
+    trace = std::make_unique<trace_ring>(records);
+}
+
+template <bus_type Bus, clock_type Clock>
+trace_record basic_cpu6502<Bus, Clock>::trace_state(uint16_t pc) const
+{
+    return { clock.get_cycles(), pc, address, oc, A, X, Y, S, status_byte(get_status()), data, control };
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::set_breakpoint(break_kind kind, uint16_t address, break_condition condition)
+{
+    if (!breakpoints)
+        breakpoints = std::make_unique<breakpoint_set>();
+    breakpoints->set(kind, address, std::move(condition));
+
+    if (kind == break_kind::read)
+        page_flags[hi_byte(address)] |= page_read_watch;
+    if (kind == break_kind::write)
+        page_flags[hi_byte(address)] |= page_write_watch;
+
+    // blocks and translations built before it would run through it
+    if (kind == break_kind::execute && block_cache) {
+        if (jit)
+            jit->flush();
+        drop_blocks();
+    }
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::clear_breakpoint(break_kind kind, uint16_t address)
+{
+    if (!breakpoints)
+        return;
+    breakpoints->clear(kind, address);
+
+    if (breakpoints->count(kind, hi_byte(address)) == 0) {
+        if (kind == break_kind::read)
+            page_flags[hi_byte(address)] &= ~page_read_watch;
+        if (kind == break_kind::write)
+            page_flags[hi_byte(address)] &= ~page_write_watch;
+    }
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::clear_breakpoints()
+{
+    breakpoints.reset();
+    interrupts.pending &= ~interrupt_lines::pending_watch;
+    for (auto& flags : page_flags)
+        flags &= ~(page_read_watch | page_write_watch);
+}
+
+template <bus_type Bus, clock_type Clock>
+bool basic_cpu6502<Bus, Clock>::at_breakpoint()
+{
+    // an interrupt taken before the first instruction isn't resuming anything
+    const bool resumed = resuming && PC == resume_pc;
+    resuming = false;
+    if (resumed || !breakpoints->contains(break_kind::execute, PC))
+        return false;
+
+    // a condition may look at P
+    store_flags();
+    return breakpoints->hit(break_kind::execute, PC);
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::watched(break_kind kind)
+{
+    // the first hit within an instruction is the one reported
+    if ((interrupts.pending & interrupt_lines::pending_watch) || !breakpoints->contains(kind, address))
+        return;
+
+    store_flags();
+    if (!breakpoints->hit(kind, address))
+        return;
+
+    watch_hit = kind == break_kind::read ? stop_reason::read_watch : stop_reason::write_watch;
+    watch_pc = instruction_pc();
+    interrupts.pending |= interrupt_lines::pending_watch;
+}
+
+template <bus_type Bus, clock_type Clock>
+cpu6502_base::stop_reason basic_cpu6502<Bus, Clock>::take_watch(uint16_t& pc)
+{
+    interrupts.pending &= ~interrupt_lines::pending_watch;
+    pc = watch_pc;
+    return watch_hit;
+}
+
+template <bus_type Bus, clock_type Clock>
+std::vector<cpu6502_base::bigram_t> basic_cpu6502<Bus, Clock>::top_bigrams(size_t count) const
+{
+    std::vector<bigram_t> top;
+    if (!bigrams)
+        return top;
+
+    for (size_t index = 0; index < bigrams->size(); index++) {
+        if ((*bigrams)[index])
+            top.push_back({ static_cast<uint8_t>(index >> 8), static_cast<uint8_t>(index), (*bigrams)[index] });
+    }
+
+    count = std::min(count, top.size());
+    std::partial_sort(top.begin(), top.begin() + count, top.end(),
+        [](const bigram_t& a, const bigram_t& b) { return a.count > b.count; });
+    top.resize(count);
+    return top;
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::report_bigrams(size_t count) const
+{
+    uint64_t total {};
+    if (bigrams) {
+        for (uint64_t pairs_seen : *bigrams)
+            total += pairs_seen;
+    }
+
+    std::stringstream ss;
+    for (const bigram_t& bigram : top_bigrams(count)) {
+        const bool is_fused = std::any_of(pairs.begin(), pairs.end(), [&](const pair_t& pair) {
+            return pair.first == bigram.first && pair.second == bigram.second;
+        });
+
+        ss << std::format("{:#04x} {:#04x} ", bigram.first, bigram.second)
+           << mnemonics.at(bigram.first) << " " << mnemonics.at(bigram.second)
+           << " count: " << bigram.count
+           << " share: " << std::format("{:.2f}%", 100.0 * bigram.count / total)
+           << (is_fused ? " fused" : "")
+           << "\n";
+    }
+
+    std::printf("%s", ss.str().c_str());
+}
+
+template <bus_type Bus, clock_type Clock>
+const typename basic_cpu6502<Bus, Clock>::decoded_t* basic_cpu6502<Bus, Clock>::predecode(uint16_t pc)
+{
+    decoded_t& entry = decode_cache->entries[pc];
+    const uint32_t generation = decode_cache->generations[hi_byte(pc)];
+    if (entry.generation == generation)
+        return &entry;
+
+    // only the instruction's own bytes are read, reading past it could hit a device register
+    uint8_t next = 0;
+    if (!peek_code(pc, next))
+        return nullptr;
+    const uint8_t length = dispatch[next].length;
+    uint16_t operand = 0;
+    for (uint8_t i = 1; i < length; i++) {
+        uint8_t byte = 0;
+        if (!peek_code(pc + i, byte))
+            return nullptr;
+        operand |= byte << (8 * (i - 1));
+    }
+
+    entry.oc = next;
+    entry.operand = operand;
+    entry.handler = dispatch[next].handler;
+    entry.cycles = dispatch[next].cycles;
+    entry.generation = generation;
+
+    const uint16_t last = pc + length - 1;
+    page_flags[hi_byte(pc)] |= page_code;
+    page_flags[hi_byte(last)] |= page_code;
+    return &entry;
+}
+
+template <bus_type Bus, clock_type Clock>
+bool basic_cpu6502<Bus, Clock>::peek_code(uint16_t address, uint8_t& byte)
+{
+    // a read from a device page has side effects, that byte is left to the interpreter
+    if constexpr (readable_pages<Bus>) {
+        const uint8_t* page = bus.read_page(hi_byte(address));
+        if (!page)
+            return false;
+        byte = page[lo_byte(address)];
+    } else {
+        byte = bus.read(address);
+    }
+    return true;
+}
+
+template <bus_type Bus, clock_type Clock>
+uint8_t basic_cpu6502<Bus, Clock>::fetch()
+{
+    address = PC;
+    PC++;
+
+    if (!predecoded)
+        return read_code();
+
+    control = true;
+    data = operand & 0xFF;
+    operand >>= 8;
+    return data;
+}
+
+template <bus_type Bus, clock_type Clock>
+uint8_t basic_cpu6502<Bus, Clock>::read_code()
+{
+    control = true;
+    data = bus.read(address);
+    return data;
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::flagged_write()
+{
+    if (page_flags[hi_byte(address)] & page_journal)
+        journal_write();
+    if (page_flags[hi_byte(address)] & page_write_watch)
+        watched(break_kind::write);
+
+    // the bus marks the page dirty now, the jit may store to it directly from here on
+    page_flags[hi_byte(address)] &= ~page_clean;
+
+    if (page_flags[hi_byte(address)] & page_code) {
+        // drop every entry whose three bytes cover the written address
+        for (uint16_t pc = address - 2, i = 0; i < 3; pc++, i++)
+            decode_cache->entries[pc].generation = 0;
+
+        if (block_cache)
+            block_cache->generations[hi_byte(address)]++;
+        code_written = true;
+    }
+}
+
+template <bus_type Bus, clock_type Clock>
+uint16_t basic_cpu6502<Bus, Clock>::instruction_pc() const
+{
+    // PC has moved past the operand by the time an instruction writes, JSR pushes before its last fetch
+    if (servicing)
+        return PC;
+    return PC - (oc == JSR____ ? 2 : dispatch[oc].length);
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::journal_write()
+{
+    const uint16_t pc = instruction_pc();
+    uint8_t old = data;
+    if constexpr (ram_bus<Bus>) {
+        if (const uint8_t* page = bus.ram_page(hi_byte(address)))
+            old = page[lo_byte(address)];
+    }
+    journal->record({ get_cycles(), pc, address, old, data });
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::watch_clean_pages()
+{
+    if constexpr (dirty_tracking<Bus>) {
+        for (size_t page = 0; page < page_flags.size(); page++) {
+            const bool clean = bus.is_tracking() && !bus.is_dirty(static_cast<uint8_t>(page));
+            page_flags[page] = clean ? page_flags[page] | page_clean : page_flags[page] & ~page_clean;
+        }
+        clean_marks = bus.get_marks();
+    }
+}
+
+template <bus_type Bus, clock_type Clock>
+bool basic_cpu6502<Bus, Clock>::is_valid(const block_t& block) const
+{
+    return block.size
+        && block.generations[0] == block_cache->generations[block.pages[0]]
+        && block.generations[1] == block_cache->generations[block.pages[1]];
+}
+
+template <bus_type Bus, clock_type Clock>
+typename basic_cpu6502<Bus, Clock>::block_t& basic_cpu6502<Bus, Clock>::lookup_block(uint16_t pc)
+{
+    auto& slot = block_cache->blocks[pc];
+    if (!slot)
+        slot = std::make_unique<block_t>();
+
+    // stale blocks are rebuilt in place so chained pointers to them stay usable
+    if (!is_valid(*slot))
+        build_block(*slot, pc);
+    return *slot;
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::build_block(block_t& block, uint16_t pc)
+{
+    const uint8_t page = hi_byte(pc);
+    uint16_t last = pc;
+
+    block.start = pc;
+    block.size = 0;
+    block.cycles = 0;
+    block.max_cycles = 0;
+    block.hits = 0;
+    block.idle = false;
+    block.trap = 0;
+    block.native = nullptr;
+    block.next = {};
+
+    bool idle = true;
+
+    // stop at control flow, at the size limit or when the next instruction starts on another page,
+    // so a block's bytes never span more than two pages
+    while (block.size < max_block_size) {
+        // execute breakpoints are checked between blocks, so one always starts a block
+        if (block.size && is_execute_breakpoint(pc))
+            break;
+
+        // code on a device page is left to the interpreter
+        const decoded_t* entry = predecode(pc);
+        if (!entry)
+            break;
+
+        const dispatch_t* info = &dispatch[entry->oc];
+        block_op_t& op = block.ops[block.size++];
+
+        op = { entry->handler, entry->operand, entry->oc, entry->cycles, 0 };
+        last = pc + info->length - 1;
+        const decoded_t* final = entry;
+
+        // fuse with the following instruction when the pair is listed and still on this page,
+        // its operand bytes follow the first instruction's in op.operand
+        const uint16_t next = pc + info->length;
+        const decoded_t* tail = !info->ends_block && hi_byte(next) == page && !is_execute_breakpoint(next)
+            ? predecode(next)
+            : nullptr;
+        if (tail) {
+            for (const pair_t& pair : pairs) {
+                if (pair.first != entry->oc || pair.second != tail->oc)
+                    continue;
+
+                const uint8_t operand_bytes = info->length - 1;
+                const uint32_t operand_mask = (1u << (8 * operand_bytes)) - 1;
+                op.handler = pair.handler;
+                op.operand = (entry->operand & operand_mask) | (static_cast<uint32_t>(tail->operand) << (8 * operand_bytes));
+                op.cycles += tail->cycles;
+                op.tail_cycles = tail->cycles;
+
+                pc = next;
+                info = &dispatch[tail->oc];
+                last = pc + info->length - 1;
+                final = tail;
+                break;
+            }
+        }
+
+        block.cycles += op.cycles;
+        block.max_cycles += op.cycles + (op.tail_cycles ? 2 : 1) * max_extra_cycles;
+        idle = idle && dispatch[entry->oc].idle_safe && info->idle_safe;
+        if (info->ends_block) {
+            // a jump or a taken branch back to the first instruction
+            const uint16_t target = final->oc == JMP_ABS
+                ? static_cast<uint16_t>(final->operand)
+                : static_cast<uint16_t>(pc + 2 + static_cast<int8_t>(final->operand));
+            block.idle = idle && target == block.start;
+            block.trap = info->idle_safe && target == pc ? info->length : 0;
+            break;
+        }
+
+        pc += info->length;
+        if (hi_byte(pc) != page)
+            break;
+    }
+
+    block.end = last + 1;
+    block.pages = { page, hi_byte(last) };
+    block.generations = { block_cache->generations[block.pages[0]], block_cache->generations[block.pages[1]] };
+}
+
+template <bus_type Bus, clock_type Clock>
+typename basic_cpu6502<Bus, Clock>::idle_state_t basic_cpu6502<Bus, Clock>::idle_state()
+{
+    return { A, X, Y, flags, clock.get_cycles() };
+}
+
+template <bus_type Bus, clock_type Clock>
+bool basic_cpu6502<Bus, Clock>::reads_only_ram(const block_t& block)
+{
+    // a device register may change with time alone, so a loop polling one is never idle,
+    // the only idle safe fused pairs end in a branch so each op reads through its first instruction
+    if constexpr (!ram_bus<Bus>) {
+        return false;
+    } else {
+        for (uint8_t i = 0; i < block.size; i++) {
+            const block_op_t& op = block.ops[i];
+            const auto addressing = instructions[op.oc].addressing;
+            if (addressing == &basic_cpu6502::ZPG && !bus.ram_page(0))
+                return false;
+            if (addressing == &basic_cpu6502::ABS && op.oc != JMP_ABS && !bus.ram_page(hi_byte(static_cast<uint16_t>(op.operand))))
+                return false;
+        }
+        return true;
+    }
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::skip_idle(const block_t& block, const idle_state_t& before, size_t deadline) noexcept
+{
+    // only an interrupt or an event can end the loop now, both wait for the deadline,
+    // the whole passes still fitting before it go on the clock at once, which lets a paced clock sleep
+    if (!idle_state().same_registers(before) || !reads_only_ram(block))
+        return;
+
+    const size_t now = clock.get_cycles();
+    const size_t pass = now - before.cycles;
+    if (now >= deadline || pass == 0)
+        return;
+
+    const size_t skipped = (deadline - now) / pass * pass;
+    clock.add_cycles(skipped);
+    idle_cycles += skipped;
+}
+
+template <bus_type Bus, clock_type Clock>
+typename basic_cpu6502<Bus, Clock>::block_t& basic_cpu6502<Bus, Clock>::successor(block_t& block)
+{
+    for (block_t* next : block.next) {
+        if (next && next->start == PC && is_valid(*next))
+            return *next;
+    }
+
+    block_t& next = lookup_block(PC);
+    block.next[block.next[0] ? 1 : 0] = &next;
+    return next;
+}
+
+template <bus_type Bus, clock_type Clock>
+bool basic_cpu6502<Bus, Clock>::execute_block(const block_t& block, uint16_t stop) noexcept
+{
+    code_written = false;
+
+    for (uint8_t i = 0; i < block.size; i++) {
+        const block_op_t& op = block.ops[i];
+        execute_decoded(op.handler, op.operand, op.oc);
+        block_cycles += op.cycles;
+
+        // a store into the block itself, reaching stop, a fused pair split halfway
+        // or an interrupt to poll cuts the block short
+        const bool stopped = address == stop;
+        if (stopped || pair_split || interrupts.pending || (code_written && !is_valid(block))) {
+            if (mode == execution_mode::instruction_accurate)
+                clock.add_cycles(block_cycles + extra_cycles - (pair_split ? op.tail_cycles : 0));
+            block_cycles = 0;
+            extra_cycles = 0;
+            pair_split = false;
+            return !stopped;
+        }
+    }
+
+    if (mode == execution_mode::instruction_accurate)
+        clock.add_cycles(block.cycles + extra_cycles);
+    block_cycles = 0;
+    extra_cycles = 0;
+    return true;
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::drop_blocks()
+{
+    for (auto& generation : block_cache->generations)
+        generation++;
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::translate(block_t& block, uint16_t stop)
+{
+    std::array<jit_x64::instruction, max_block_size * 2> ops;
+
+    // fused pairs are translated one instruction at a time,
+    // translations end before CLI, SEI and PLP so interrupt polling sees every change of I
+    size_t count = 0;
+    for (uint16_t pc = block.start; pc != block.end; count++) {
+        const decoded_t* entry = predecode(pc);
+        if (!entry || entry->oc == CLI_IMP || entry->oc == SEI_IMP || entry->oc == PLP_IMP)
+            break;
+
+        const uint8_t length = dispatch[entry->oc].length;
+        ops[count] = { pc, entry->operand, entry->oc, entry->cycles, length };
+        pc += length;
+    }
+
+    block.native = jit->translate(ops.data(), count, stop);
+    if (!block.native && jit->is_full()) {
+        // start over, blocks still hot get translated again
+        jit->flush();
+        drop_blocks();
+    }
+}
+
+template <bus_type Bus, clock_type Clock>
+bool basic_cpu6502<Bus, Clock>::execute_native(const block_t& block, uint16_t stop)
+{
+    jit_x64::context& ctx = jit->ctx;
+    ctx.page_flags = page_flags.data();
+    ctx.A = A;
+    ctx.X = X;
+    ctx.Y = Y;
+    ctx.S = S;
+    store_flags();
+    ctx.P = status_byte(P);
+
+    block.native(&ctx);
+
+    A = ctx.A;
+    X = ctx.X;
+    Y = ctx.Y;
+    S = ctx.S;
+    P = status_byte(ctx.P);
+    load_flags();
+    PC = ctx.pc;
+    clock.add_cycles(ctx.cycles);
+
+    switch (ctx.exit) {
+    case jit_x64::stopped:
+        address = stop;
+        return false;
+
+    case jit_x64::fallback:
+        // guarded store, non-RAM access or an instruction the translator skips
+        step();
+        return address != stop;
+
+    default:
+        return true;
+    }
 }
 
-void cpu6502::reset()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::reset()
 {
     oc = {};
 
@@ -141,51 +1526,57 @@ void cpu6502::reset()
 
     S = 0xFF;
     P = {};
+    interrupts.pending &= ~(interrupt_lines::pending_nmi | interrupt_lines::pending_mask | interrupt_lines::pending_halt | interrupt_lines::pending_watch);
+    load_flags();
 
     address = {};
     data = {};
+
+    invalidate_decode_cache();
 }
 
-void cpu6502::add_register(uint8_t& byte, uint8_t reg)
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::add_register(uint8_t& byte, uint8_t reg)
 {
     byte += reg;
     add_carry = byte < reg;
 }
 
-void cpu6502::ACC()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::ACC()
 {
     acc_addressing = true;
     IMP();
 }
 
-void cpu6502::IMP()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::IMP()
 {
     address = PC;
     read();
     cycle();
 }
 
-void cpu6502::IMM()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::IMM()
 {
     address = PC;
     PC++;
 }
 
-void cpu6502::ZPG()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::ZPG()
 {
-    address = PC;
-    PC++;
-    uint8_t adl = read();
+    uint8_t adl = fetch();
     cycle();
 
     address = adl;
 }
 
-void cpu6502::zero_page(uint8_t reg)
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::zero_page(uint8_t reg)
 {
-    address = PC;
-    PC++;
-    uint8_t bal = read();
+    uint8_t bal = fetch();
     cycle();
 
     address = bal;
@@ -195,69 +1586,64 @@ void cpu6502::zero_page(uint8_t reg)
     address = bal;
 }
 
-void cpu6502::ZPX()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::ZPX()
 {
     zero_page(X);
 }
 
-void cpu6502::ZPY()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::ZPY()
 {
     zero_page(Y);
 }
 
-void cpu6502::ABS()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::ABS()
 {
-    address = PC;
-    PC++;
-    uint8_t adl = read();
+    uint8_t adl = fetch();
     cycle();
 
-    address = PC;
-    PC++;
-    uint8_t adh = read();
+    uint8_t adh = fetch();
     cycle();
 
     address = (adh << 8) | adl;
 }
 
-void cpu6502::absolute(uint8_t reg)
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::absolute(uint8_t reg)
 {
     add_cycle = cycle_mode::if_carry;
 
-    address = PC;
-    PC++;
-    uint8_t bal = read();
+    uint8_t bal = fetch();
     cycle();
 
-    address = PC;
-    PC++;
     add_register(bal, reg);
-    uint8_t bah = read();
+    uint8_t bah = fetch();
     cycle();
 
     address = (bah << 8) | bal;
 }
 
-void cpu6502::ABX()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::ABX()
 {
     absolute(X);
 }
 
-void cpu6502::ABY()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::ABY()
 {
     absolute(Y);
 }
 
-void cpu6502::IND()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::IND()
 {
-    address = PC;
-    PC++;
-    uint8_t ial = read();
+    uint8_t ial = fetch();
     cycle();
 
-    address = PC;
-    PC++;
-    uint8_t iah = read();
+    uint8_t iah = fetch();
     cycle();
 
     address = (iah << 8) | ial;
@@ -271,11 +1657,10 @@ void cpu6502::IND()
     address = (adh << 8) | adl;
 }
 
-void cpu6502::IDX()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::IDX()
 {
-    address = PC;
-    PC++;
-    uint8_t bal = read();
+    uint8_t bal = fetch();
     cycle();
 
     address = bal;
@@ -294,13 +1679,12 @@ void cpu6502::IDX()
     address = (adh << 8) | adl;
 }
 
-void cpu6502::IDY()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::IDY()
 {
     add_cycle = cycle_mode::if_carry;
 
-    address = PC;
-    PC++;
-    uint8_t ial = read();
+    uint8_t ial = fetch();
     cycle();
 
     address = ial;
@@ -315,7 +1699,8 @@ void cpu6502::IDY()
     address = (bah << 8) | bal;
 }
 
-void cpu6502::extra_cycle()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::extra_cycle()
 {
     switch (add_cycle) {
     case cycle_mode::never:
@@ -326,6 +1711,7 @@ void cpu6502::extra_cycle()
             address += 0x0100;
             read();
             cycle();
+            extra_cycles++;
         }
         break;
 
@@ -341,13 +1727,11 @@ void cpu6502::extra_cycle()
         read();
         cycle();
         break;
-
-    default:
-        throw std::exception("");
     }
 }
 
-void cpu6502::load()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::load()
 {
     read();
     cycle();
@@ -355,31 +1739,32 @@ void cpu6502::load()
     extra_cycle();
 }
 
-void cpu6502::LDA()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::LDA()
 {
     load();
     A = data;
-    P.Z = is_zero(A);
-    P.N = is_negative(A);
+    set_nz(A);
 }
 
-void cpu6502::LDX()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::LDX()
 {
     load();
     X = data;
-    P.Z = is_zero(X);
-    P.N = is_negative(X);
+    set_nz(X);
 }
 
-void cpu6502::LDY()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::LDY()
 {
     load();
     Y = data;
-    P.Z = is_zero(Y);
-    P.N = is_negative(Y);
+    set_nz(Y);
 }
 
-void cpu6502::store(uint8_t reg)
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::store(uint8_t reg)
 {
     if (add_cycle == cycle_mode::if_carry)
         add_cycle = cycle_mode::if_carry_possible;
@@ -391,59 +1776,69 @@ void cpu6502::store(uint8_t reg)
     cycle();
 }
 
-void cpu6502::STA()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::STA()
 {
     store(A);
 }
 
-void cpu6502::STX()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::STX()
 {
     store(X);
 }
 
-void cpu6502::STY()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::STY()
 {
     store(Y);
 }
 
-void cpu6502::transfer(uint8_t src, uint8_t& dst)
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::transfer(uint8_t src, uint8_t& dst)
 {
     dst = src;
-    P.Z = is_zero(dst);
-    P.N = is_negative(dst);
+    set_nz(dst);
 }
 
-void cpu6502::TAX()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::TAX()
 {
     transfer(A, X);
 };
 
-void cpu6502::TAY()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::TAY()
 {
     transfer(A, Y);
 };
 
-void cpu6502::TXA()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::TXA()
 {
     transfer(X, A);
 };
 
-void cpu6502::TYA()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::TYA()
 {
     transfer(Y, A);
 };
 
-void cpu6502::TSX()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::TSX()
 {
     transfer(S, X);
 };
 
-void cpu6502::TXS()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::TXS()
 {
     S = X;
 };
 
-void cpu6502::push()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::push()
 {
     address = stack_address(S);
     S--;
@@ -451,19 +1846,23 @@ void cpu6502::push()
     cycle();
 }
 
-void cpu6502::PHA()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::PHA()
 {
     data = A;
     push();
 };
 
-void cpu6502::PHP()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::PHP()
 {
+    store_flags();
     data = status_byte(P);
     push();
 };
 
-void cpu6502::pull()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::pull()
 {
     address = stack_address(S);
     S++;
@@ -475,106 +1874,116 @@ void cpu6502::pull()
     cycle();
 }
 
-void cpu6502::PLA()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::PLA()
 {
     pull();
     A = data;
-    P.Z = is_zero(A);
-    P.N = is_negative(A);
+    set_nz(A);
 };
 
-void cpu6502::PLP()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::PLP()
 {
     pull();
     P = status_byte(data);
+    interrupts.pending |= interrupt_lines::pending_mask;
+    load_flags();
 };
 
-void cpu6502::AND()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::AND()
 {
     load();
     A = A & data;
-    P.Z = is_zero(A);
-    P.N = is_negative(A);
+    set_nz(A);
 };
 
-void cpu6502::EOR()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::EOR()
 {
     load();
     A = A ^ data;
-    P.Z = is_zero(A);
-    P.N = is_negative(A);
+    set_nz(A);
 };
 
-void cpu6502::ORA()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::ORA()
 {
     load();
     A = A | data;
-    P.Z = is_zero(A);
-    P.N = is_negative(A);
+    set_nz(A);
 };
 
-void cpu6502::BIT()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::BIT()
 {
     load();
-    P.Z = is_zero(A & data);
-    P.N = is_negative(data);
-    P.V = is_bit_set(data, 6);
+    flags.z = A & data;
+    flags.n = data;
+    flags.v = is_bit_set(data, 6);
 };
 
-void cpu6502::add(bool substract)
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::add(bool substract)
 {
     uint8_t byte = data;
 
     if (substract)
         byte = ~byte;
 
-    uint16_t result = A + byte + P.C;
+    uint16_t result = A + byte + flags.c;
 
-    P.C = result > 0xFF;
+    flags.c = result > 0xFF;
     uint8_t lo_result = static_cast<uint8_t>(result);
-    P.V = ((A ^ lo_result) & (byte ^ lo_result) & 0x80) != 0;
+    flags.v = ((A ^ lo_result) & (byte ^ lo_result) & 0x80) != 0;
 
     A = lo_result;
-    P.Z = is_zero(A);
-    P.N = is_negative(A);
+    set_nz(A);
 }
 
-void cpu6502::ADC()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::ADC()
 {
     load();
     add(false);
 };
 
-void cpu6502::SBC()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::SBC()
 {
     load();
     add(true);
 };
 
-void cpu6502::compare(uint8_t reg)
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::compare(uint8_t reg)
 {
     load();
-    P.C = reg >= data;
-    P.Z = is_zero(reg - data);
-    P.N = is_negative(reg - data);
+    flags.c = reg >= data;
+    set_nz(static_cast<uint8_t>(reg - data));
 }
 
-void cpu6502::CMP()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::CMP()
 {
     compare(A);
 };
 
-void cpu6502::CPX()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::CPX()
 {
     compare(X);
 };
 
-void cpu6502::CPY()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::CPY()
 {
     compare(Y);
 };
 
-void cpu6502::INC()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::INC()
 {
     auto inc = [&](auto& reg) {
         reg++;
@@ -582,35 +1991,37 @@ void cpu6502::INC()
 
     modify(inc);
 
-    P.Z = is_zero(data);
-    P.N = is_negative(data);
+    set_nz(data);
 };
 
-void cpu6502::increment(uint8_t& reg)
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::increment(uint8_t& reg)
 {
     reg++;
-    P.Z = is_zero(reg);
-    P.N = is_negative(reg);
+    set_nz(reg);
 }
 
-void cpu6502::INX()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::INX()
 {
     increment(X);
 };
 
-void cpu6502::INY()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::INY()
 {
     increment(Y);
 };
 
-void cpu6502::decrement(uint8_t& reg)
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::decrement(uint8_t& reg)
 {
     reg--;
-    P.Z = is_zero(reg);
-    P.N = is_negative(reg);
+    set_nz(reg);
 }
 
-void cpu6502::DEC()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::DEC()
 {
     auto dec = [&](auto& reg) {
         reg--;
@@ -618,84 +2029,85 @@ void cpu6502::DEC()
 
     modify(dec);
 
-    P.Z = is_zero(data);
-    P.N = is_negative(data);
+    set_nz(data);
 };
 
-void cpu6502::DEX()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::DEX()
 {
     decrement(X);
 };
 
-void cpu6502::DEY()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::DEY()
 {
     decrement(Y);
 };
 
-void cpu6502::ASL()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::ASL()
 {
     auto asl = [&](auto& reg) {
         auto is_carry = is_bit_set(reg, 7);
         reg = reg << 1;
-        P.C = is_carry;
-        P.Z = is_zero(reg);
-        P.N = is_negative(reg);
+        flags.c = is_carry;
+        set_nz(reg);
     };
 
     modify(asl);
 };
 
-void cpu6502::LSR()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::LSR()
 {
     auto lsr = [&](auto& reg) {
         auto is_carry = is_bit_set(reg, 0);
         reg = reg >> 1;
-        P.C = is_carry;
-        P.Z = is_zero(reg);
-        P.N = is_negative(reg);
+        flags.c = is_carry;
+        set_nz(reg);
     };
 
     modify(lsr);
 };
 
-void cpu6502::ROL()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::ROL()
 {
     auto rol = [&](auto& reg) {
         auto is_carry = is_bit_set(reg, 7);
         reg = reg << 1;
-        reg = reg | P.C;
-        P.C = is_carry;
-        P.Z = is_zero(reg);
-        P.N = is_negative(reg);
+        reg = reg | flags.c;
+        flags.c = is_carry;
+        set_nz(reg);
     };
 
     modify(rol);
 };
 
-void cpu6502::ROR()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::ROR()
 {
     auto ror = [&](auto& reg) {
         auto is_carry = is_bit_set(reg, 0);
         reg = reg >> 1;
-        reg = reg | (P.C << 7);
-        P.C = is_carry;
-        P.Z = is_zero(reg);
-        P.N = is_negative(reg);
+        reg = reg | (flags.c << 7);
+        flags.c = is_carry;
+        set_nz(reg);
     };
 
     modify(ror);
 };
 
-void cpu6502::JMP()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::JMP()
 {
     PC = address;
 };
 
-void cpu6502::JSR()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::JSR()
 {
-    address = PC;
-    PC++;
-    uint8_t adl = read();
+    uint8_t adl = fetch();
     cycle();
 
     address = stack_address(S);
@@ -713,13 +2125,16 @@ void cpu6502::JSR()
     write();
     cycle();
 
-    address = PC;
-    uint8_t adh = read();
+    // on the stack page the pushes may have overwritten the high byte, decoded or not it is fetched now
+    if (hi_byte(PC) == 0x01)
+        predecoded = false;
+    uint8_t adh = fetch();
     PC = (adh << 8) | adl;
     cycle();
 };
 
-void cpu6502::RTS()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::RTS()
 {
     address = stack_address(S);
     S++;
@@ -740,11 +2155,10 @@ void cpu6502::RTS()
     cycle();
 };
 
-void cpu6502::branch(bool is_branch)
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::branch(bool is_branch)
 {
-    address = PC;
-    PC++;
-    int8_t offset = read(); // signed
+    int8_t offset = fetch(); // signed
     cycle();
 
     if (!is_branch)
@@ -761,6 +2175,7 @@ void cpu6502::branch(bool is_branch)
     PC = (pch << 8) | lo;
     address = PC;
     cycle();
+    extra_cycles++;
 
     if (hi == pch)
         return;
@@ -768,84 +2183,103 @@ void cpu6502::branch(bool is_branch)
     PC = (hi << 8) | lo;
     address = PC;
     cycle();
+    extra_cycles++;
 }
 
-void cpu6502::BCC()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::BCC()
 {
-    branch(!P.C);
+    branch(!flags.c);
 };
 
-void cpu6502::BCS()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::BCS()
 {
-    branch(P.C);
+    branch(flags.c);
 };
 
-void cpu6502::BNE()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::BNE()
 {
-    branch(!P.Z);
+    branch(flags.z != 0);
 };
 
-void cpu6502::BEQ()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::BEQ()
 {
-    branch(P.Z);
+    branch(flags.z == 0);
 };
 
-void cpu6502::BPL()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::BPL()
 {
-    branch(!P.N);
+    branch(!is_negative(flags.n));
 };
 
-void cpu6502::BMI()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::BMI()
 {
-    branch(P.N);
+    branch(is_negative(flags.n));
 };
 
-void cpu6502::BVC()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::BVC()
 {
-    branch(!P.V);
+    branch(!flags.v);
 };
 
-void cpu6502::BVS()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::BVS()
 {
-    branch(P.V);
+    branch(flags.v);
 };
 
-void cpu6502::CLC()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::CLC()
 {
-    P.C = 0;
+    flags.c = false;
 };
 
-void cpu6502::CLD()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::CLD()
 {
     P.D = 0;
 };
 
-void cpu6502::CLI()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::CLI()
 {
     P.I = 0;
+    interrupts.pending |= interrupt_lines::pending_mask;
 };
 
-void cpu6502::CLV()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::CLV()
 {
-    P.V = 0;
+    flags.v = false;
 };
 
-void cpu6502::SEC()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::SEC()
 {
-    P.C = 1;
+    flags.c = true;
 };
 
-void cpu6502::SED()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::SED()
 {
     P.D = 1;
 };
 
-void cpu6502::SEI()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::SEI()
 {
     P.I = 1;
+    interrupts.pending |= interrupt_lines::pending_mask;
 };
 
-void cpu6502::RTI()
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::RTI()
 {
     address = stack_address(S);
     S++;
@@ -854,6 +2288,7 @@ void cpu6502::RTI()
     address = stack_address(S);
     S++;
     P = status_byte(read());
+    load_flags();
     cycle();
 
     address = stack_address(S);
@@ -867,10 +2302,13 @@ void cpu6502::RTI()
     cycle();
 };
 
-void cpu6502::interrupt(const interrupt_vec& vec)
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::interrupt(const interrupt_vec& vec, bool brk)
 {
+    // BRK skips its padding byte, IRQ and NMI return to the instruction they preempted
     address = PC;
-    PC++;
+    if (brk)
+        PC++;
     cycle();
 
     address = stack_address(S);
@@ -887,28 +2325,99 @@ void cpu6502::interrupt(const interrupt_vec& vec)
 
     address = stack_address(S);
     S--;
-    data = status_byte(P);
+    store_flags();
+    status pushed = P;
+    pushed.B = brk;
+    data = status_byte(pushed);
     write();
     cycle();
 
-    address = vec.first;
+    // an NMI arriving during BRK takes over its vector
+    const bool hijacked = brk && (interrupts.pending & interrupt_lines::pending_nmi);
+    if (hijacked)
+        interrupts.pending &= ~interrupt_lines::pending_nmi;
+    const interrupt_vec& target = hijacked ? NMI_VEC : vec;
+
+    address = target.first;
     uint8_t adl = read();
     cycle();
 
-    address = vec.second;
+    address = target.second;
     uint8_t adh = read();
     PC = (adh << 8) | adl;
     cycle();
 
     P.I = 1;
+    interrupts.set_masked(true);
 };
 
-void cpu6502::BRK()
+template <bus_type Bus, clock_type Clock>
+bool basic_cpu6502<Bus, Clock>::poll_interrupts()
 {
-    interrupt(IRQ_VEC);
+    // decided on I as it was before CLI, SEI or PLP, which only count from the next boundary on
+    const uint8_t pending = interrupts.pending;
+    if (pending & interrupt_lines::pending_halt)
+        return true; // nothing runs in place of the jammed instruction either
+
+    interrupts.pending &= ~interrupt_lines::pending_event;
+    if (pending & interrupt_lines::pending_mask) {
+        interrupts.pending &= ~interrupt_lines::pending_mask;
+        interrupts.set_masked(P.I);
+    }
+
+    if (pending & interrupt_lines::pending_nmi) {
+        interrupts.pending &= ~interrupt_lines::pending_nmi;
+        service_interrupt(NMI_VEC);
+        return true;
+    }
+
+    if (pending & interrupt_lines::pending_irq) {
+        service_interrupt(IRQ_VEC);
+        return true;
+    }
+
+    return false;
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::service_interrupt(const interrupt_vec& vec)
+{
+    // the opcode at PC is fetched and dropped, then it goes like BRK
+    address = PC;
+    read();
+    cycle();
+
+    servicing = true;
+    interrupt(vec, false);
+    servicing = false;
+
+    if (mode == execution_mode::instruction_accurate)
+        clock.add_cycles(7);
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::BRK()
+{
+    interrupt(IRQ_VEC, true);
 };
 
-void IRQ() {};
-void NMI() {};
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::SKP()
+{
+    load();
+}
+
+template <bus_type Bus, clock_type Clock>
+void basic_cpu6502<Bus, Clock>::JAM()
+{
+    // NMOS silicon locks up with the opcode on the bus, PC stays on it
+    PC--;
+    interrupts.pending |= interrupt_lines::pending_halt;
+}
+
+template class basic_cpu6502<i_bus, i_clock>;
+template class basic_cpu6502<memory64k, clock>;
+template class basic_cpu6502<memory64k, realtime_clock>;
+template class basic_cpu6502<paged_bus, clock>;
 
 }
\ No newline at end of file
@@ -1,28 +1,18 @@
 #pragma once
 
+#include "breakpoints.h"
 #include "i_bus.h"
 #include "i_clock.h"
+#include "interrupt_lines.h"
+#include "jit_x64.h"
+#include "trace.h"
 #include "types.h"
+#include "write_journal.h"
 
 namespace emulator {
 
-class cpu6502 {
+class cpu6502_base {
 public:
-    cpu6502(i_clock& clock, i_bus& bus);
-
-    i_clock& clock;
-    i_bus& bus;
-
-    uint8_t oc {}; // opcode
-
-    uint8_t A {}; // accumulator
-    uint8_t X {}; // X register
-    uint8_t Y {}; // Y register
-
-    uint16_t PC {}; // program counter
-
-    uint8_t S {}; // stack pointer
-
     struct status {
         uint8_t C : 1 = 0; // carry flag
         uint8_t Z : 1 = 0; // zero flag
@@ -34,128 +24,74 @@ public:
         uint8_t N : 1 = 0; // negative flag
     };
 
-    status P {}; // processor status register
-
-    uint16_t address {}; // address bus
-    uint8_t data {}; // data bus
-    bool control = true; // r/w flag
-
-    using interrupt_vec = std::pair<uint16_t, uint16_t>;
-    interrupt_vec NMI_VEC = { 0xFFFA, 0xFFFB };
-    interrupt_vec RES_VEC = { 0xFFFC, 0xFFFD };
-    interrupt_vec IRQ_VEC = { 0xFFFE, 0xFFFF };
-
-    void log(bool show);
-
-    void run(uint16_t stop);
-    void cycle();
-    uint8_t read();
-    void write();
-
-    void execute();
-    void reset();
-
-private:
-    // adressing modes
-    void ACC(); // accumulator
-    void IMP(); // implied
-    void IMM(); // immediate
-    void ZPG(); // zero page
-    void ZPX(); // zero page, X
-    void ZPY(); // zero page, Y
-    void ABS(); // absolute
-    void ABX(); // absolute, X
-    void ABY(); // absolute, Y
-    void IND(); // indirect
-    void IDX(); // indexed indirect
-    void IDY(); // indirect indexed
-
-    // load operations
-    void LDA();
-    void LDX();
-    void LDY();
-
-    // store operations
-    void STA();
-    void STX();
-    void STY();
-
-    // register transfers
-    void TAX();
-    void TAY();
-    void TXA();
-    void TYA();
-
-    // stack operations
-    void TSX();
-    void TXS();
-    void PHA();
-    void PHP();
-    void PLA();
-    void PLP();
-
-    // logical
-    void AND();
-    void EOR();
-    void ORA();
-    void BIT();
-
-    // arithmetic
-    void ADC();
-    void SBC();
-    void CMP();
-    void CPX();
-    void CPY();
+    enum class execution_mode {
+        cycle_accurate, // clock ticks on every bus cycle
+        instruction_accurate // clock advances once per instruction
+    };
 
-    // increments & decrements
-    void INC();
-    void INX();
-    void INY();
-    void DEC();
-    void DEX();
-    void DEY();
+    struct bigram_t {
+        uint8_t first;
+        uint8_t second;
+        uint64_t count;
+    };
 
-    // shifts
-    void ASL();
-    void LSR();
-    void ROL();
-    void ROR();
+    static constexpr size_t no_deadline = std::numeric_limits<size_t>::max();
+    static constexpr size_t unlimited = std::numeric_limits<size_t>::max();
+
+    enum class stop_reason {
+        address, // the bus address reached the stop address
+        deadline, // the clock reached the deadline
+        cycles, // the cycle budget ran out
+        instructions, // the instruction budget ran out
+        trap, // a jump or branch to itself, how test suites report a failure
+        brk, // a BRK ran
+        jam, // an opcode halted the cpu, see is_halted
+        breakpoint, // PC reached an execute breakpoint, the instruction there hasn't run
+        read_watch, // the last instruction read a watched address
+        write_watch // the last instruction wrote a watched address
+    };
 
-    // jumps & calls
-    void JMP();
-    void JSR();
-    void RTS();
+    // what ends a run besides its deadline, budgets count from the start of the run
+    struct stop_conditions {
+        uint16_t address {}; // bus address, as run(uint16_t) takes it
+        size_t cycles = unlimited; // checked like a deadline, the last instruction may pass it
+        size_t instructions = unlimited; // runs one instruction at a time, without blocks or the jit
+        bool trap = false; // off by default, a loop waiting for an interrupt looks the same
+        bool brk = false;
+    };
 
-    // branches
-    void BCC();
-    void BCS();
-    void BNE();
-    void BEQ();
-    void BPL();
-    void BMI();
-    void BVC();
-    void BVS();
+    struct run_result {
+        stop_reason reason;
+        uint16_t pc; // of the trapping instruction, the BRK or the instruction a watchpoint saw, PC otherwise
+        size_t cycles; // spent by the run
+    };
 
-    // status flag changes
-    void CLC();
-    void CLD();
-    void CLI();
-    void CLV();
-    void SEC();
-    void SED();
-    void SEI();
+    // the cpu between two instructions, with the clock and the interrupt lines, trivially copyable
+    // so a machine checkpoint is a plain copy, what only lives within an instruction starts over with the next one
+    struct cpu_state {
+        size_t cycles;
+        uint16_t PC;
+        uint16_t address;
+        uint8_t A;
+        uint8_t X;
+        uint8_t Y;
+        uint8_t S;
+        status P;
+        uint8_t oc;
+        uint8_t data;
+        bool control;
+        interrupt_lines interrupts;
+    };
+    static_assert(std::is_trivially_copyable_v<interrupt_lines>);
 
-    // interrupts
-    void RTI();
-    void BRK();
-    void IRQ() {};
-    void NMI() {};
+    using interrupt_vec = std::pair<uint16_t, uint16_t>;
+    static constexpr interrupt_vec NMI_VEC = { 0xFFFA, 0xFFFB };
+    static constexpr interrupt_vec RES_VEC = { 0xFFFC, 0xFFFD };
+    static constexpr interrupt_vec IRQ_VEC = { 0xFFFE, 0xFFFF };
 
-    void NOP() {};
-    void ___() {};
-    void JAM() { throw std::exception("invalid opcode!"); }
+    // cold per-opcode metadata, kept apart from the dispatch data
+    static const std::array<std::string_view, 256> mnemonics;
 
-public:
     enum opcode : uint8_t {
         BRK____ = 0x00,
         ORA_IDX = 0x01,
@@ -414,273 +350,218 @@ public:
         INC_ABX = 0xFE,
         _0xFF__ = 0xFF,
     };
+};
+
+// Bus and Clock are either the i_bus/i_clock interfaces or concrete implementations,
+// the latter let the compiler inline every bus access and clock tick,
+// instantiations are listed at the end of cpu6502.cpp
+template <bus_type Bus, clock_type Clock>
+class basic_cpu6502 : public cpu6502_base {
+public:
+    basic_cpu6502(Clock& clock, Bus& bus);
+    ~basic_cpu6502();
+
+    Clock& clock;
+    Bus& bus;
+
+    uint8_t oc {}; // opcode
+
+    uint8_t A {}; // accumulator
+    uint8_t X {}; // X register
+    uint8_t Y {}; // Y register
+
+    uint16_t PC {}; // program counter
+
+    uint8_t S {}; // stack pointer
+
+    status P {}; // processor status register, N/Z/C/V are written back when run or execute returns, get_status is current during them too
+
+    interrupt_lines interrupts; // polled between instructions, a pending interrupt runs in place of the next one
+
+    uint16_t address {}; // address bus
+    uint8_t data {}; // data bus
+    bool control = true; // r/w flag
+
+    execution_mode mode = execution_mode::cycle_accurate;
+
+    // runs until the bus address reaches stop, or until the clock reaches deadline
+    // when the next instruction or block could pass it, the scheduler's slices end that way,
+    // deadline is read again after every pending_event so a scheduler can bring it closer mid-run
+    run_result run(uint16_t stop, const size_t& deadline = no_deadline) noexcept { return run(stop_conditions { stop }, deadline); }
+
+    // the same, also ending on the budgets, trap or BRK that conditions ask for
+    run_result run(const stop_conditions& conditions, const size_t& deadline = no_deadline) noexcept;
+    void cycle();
+    uint8_t read();
+    void write();
+
+    void execute() noexcept;
+    void reset();
+
+    // save and restore between instructions, restore drops decoded code since memory usually goes back with it
+    cpu_state save();
+    void restore(const cpu_state& state);
+
+    // a KIL opcode stops the cpu on itself until reset,
+    // execute does nothing and run returns at once, interrupts aren't taken
+    bool is_halted() const { return interrupts.pending & interrupt_lines::pending_halt; }
+
+    // P with the N/Z/C/V the core keeps unpacked while run or execute is on, for devices and breakpoint conditions
+    status get_status() const;
+
+    // the clock as of the instruction in flight, includes what a running block has spent so far,
+    // catch-up devices read it to know how far to advance
+    size_t get_cycles();
+
+    // opt-in cache of decoded instructions keyed by PC, only for code running out of plain memory,
+    // writes through the cpu invalidate it, anything else changing code must call invalidate_decode_cache
+    void enable_decode_cache(bool enabled);
+    void invalidate_decode_cache();
+
+    // the bus shows other memory in these pages now, drops what was decoded or translated from them,
+    // buses with an on_remap hook call it on their own
+    void remap_pages(uint8_t first, size_t count);
+
+    // opt-in block mode, where run executes straight-line code as chained blocks and skips idle loops to the deadline
+    void enable_block_mode(bool enabled);
+    size_t get_idle_cycles() const { return idle_cycles; } // skipped in idle loops so far
+
+    // opt-in native tier on top of block mode, hot blocks run as x86-64 code in instruction accurate runs,
+    // needs a ram_bus and an x86-64 host, returns whether it is active,
+    // translated code keeps A/X/Y/S/P, PC and the clock exact but not the address and data bus in between
+    bool enable_jit(bool enabled);
+
+    // opt-in count of consecutive opcode pairs run by the interpreter, used to pick the pairs block mode fuses
+    void enable_bigram_profile(bool enabled);
+    std::vector<bigram_t> top_bigrams(size_t count) const;
+    void report_bigrams(size_t count = 16) const;
+
+    // opt-in record of every write with its cycle, PC and the byte it replaced
+    void enable_write_journal(bool enabled);
+    const write_journal* get_write_journal() const { return journal.get(); } // null while off
+
+    // an execute breakpoint stops run before the instruction at its address and a watchpoint after the access
+    void set_breakpoint(break_kind kind, uint16_t address, break_condition condition = {});
+    void clear_breakpoint(break_kind kind, uint16_t address);
+    void clear_breakpoints();
+
+    // opt-in ring of the last instructions run and execute went through, kept as binary records
+    // and formatted only by trace_ring::dump, a traced run goes one instruction at a time without blocks or the jit,
+    // enabling it again starts an empty ring
+    void enable_trace(bool enabled, size_t records = 4096);
+    const trace_ring* get_trace() const { return trace.get(); } // null while off
+    trace_record trace_state(uint16_t pc) const; // the cpu now, as a record of the instruction started at pc
+
+private:
+    // adressing modes
+    void ACC(); // accumulator
+    void IMP(); // implied
+    void IMM(); // immediate
+    void ZPG(); // zero page
+    void ZPX(); // zero page, X
+    void ZPY(); // zero page, Y
+    void ABS(); // absolute
+    void ABX(); // absolute, X
+    void ABY(); // absolute, Y
+    void IND(); // indirect
+    void IDX(); // indexed indirect
+    void IDY(); // indirect indexed
+
+    // load operations
+    void LDA();
+    void LDX();
+    void LDY();
+
+    // store operations
+    void STA();
+    void STX();
+    void STY();
+
+    // register transfers
+    void TAX();
+    void TAY();
+    void TXA();
+    void TYA();
+
+    // stack operations
+    void TSX();
+    void TXS();
+    void PHA();
+    void PHP();
+    void PLA();
+    void PLP();
+
+    // logical
+    void AND();
+    void EOR();
+    void ORA();
+    void BIT();
+
+    // arithmetic
+    void ADC();
+    void SBC();
+    void CMP();
+    void CPX();
+    void CPY();
+
+    // increments & decrements
+    void INC();
+    void INX();
+    void INY();
+    void DEC();
+    void DEX();
+    void DEY();
+
+    // shifts
+    void ASL();
+    void LSR();
+    void ROL();
+    void ROR();
+
+    // jumps & calls
+    void JMP();
+    void JSR();
+    void RTS();
+
+    // branches
+    void BCC();
+    void BCS();
+    void BNE();
+    void BEQ();
+    void BPL();
+    void BMI();
+    void BVC();
+    void BVS();
+
+    // status flag changes
+    void CLC();
+    void CLD();
+    void CLI();
+    void CLV();
+    void SEC();
+    void SED();
+    void SEI();
+
+    // interrupts
+    void RTI();
+    void BRK();
+
+    void NOP() {};
+    void SKP(); // the undocumented NOPs with an operand, read it and drop it
+    void ___() {};
+    void JAM();
+
+public:
+    using handler_t = void (*)(basic_cpu6502&) noexcept;
 
     struct instruction_t {
         opcode op;
-        std::string name;
-        std::function<void(cpu6502&)> operation;
-        std::function<void(cpu6502&)> addressing;
+        void (basic_cpu6502::*operation)();
+        void (basic_cpu6502::*addressing)();
         int cycles {};
     };
 
-    const std::array<instruction_t, 256> instructions { {
-        { BRK____, "BRK", &cpu6502::BRK, &cpu6502::___, 7 }, // 0x00
-        { ORA_IDX, "ORA", &cpu6502::ORA, &cpu6502::IDX, 6 }, // 0x01
-        { _0x02__, "x02", &cpu6502::___, &cpu6502::___, 0 }, // 0x02
-        { _0x03__, "x03", &cpu6502::___, &cpu6502::___, 0 }, // 0x03
-        { _0x04__, "x04", &cpu6502::___, &cpu6502::___, 0 }, // 0x04
-        { ORA_ZPG, "ORA", &cpu6502::ORA, &cpu6502::ZPG, 3 }, // 0x05
-        { ASL_ZPG, "ASL", &cpu6502::ASL, &cpu6502::ZPG, 5 }, // 0x06
-        { _0x07__, "x07", &cpu6502::___, &cpu6502::___, 0 }, // 0x07
-        { PHP_IMP, "PHP", &cpu6502::PHP, &cpu6502::IMP, 3 }, // 0x08
-        { ORA_IMM, "ORA", &cpu6502::ORA, &cpu6502::IMM, 2 }, // 0x09
-        { ASL_ACC, "ASL", &cpu6502::ASL, &cpu6502::ACC, 2 }, // 0x0A
-        { _0x0B__, "x0B", &cpu6502::___, &cpu6502::___, 0 }, // 0x0B
-        { _0x0C__, "x0C", &cpu6502::___, &cpu6502::___, 0 }, // 0x0C
-        { ORA_ABS, "ORA", &cpu6502::ORA, &cpu6502::ABS, 4 }, // 0x0D
-        { ASL_ABS, "ASL", &cpu6502::ASL, &cpu6502::ABS, 6 }, // 0x0E
-        { _0x0F__, "x0F", &cpu6502::___, &cpu6502::___, 0 }, // 0x0F
-        { BPL____, "BPL", &cpu6502::BPL, &cpu6502::___, 2 }, // 0x10
-        { ORA_IDY, "ORA", &cpu6502::ORA, &cpu6502::IDY, 5 }, // 0x11
-        { _0x12__, "x12", &cpu6502::___, &cpu6502::___, 0 }, // 0x12
-        { _0x13__, "x13", &cpu6502::___, &cpu6502::___, 0 }, // 0x13
-        { _0x14__, "x14", &cpu6502::___, &cpu6502::___, 0 }, // 0x14
-        { ORA_ZPX, "ORA", &cpu6502::ORA, &cpu6502::ZPX, 4 }, // 0x15
-        { ASL_ZPX, "ASL", &cpu6502::ASL, &cpu6502::ZPX, 6 }, // 0x16
-        { _0x17__, "x17", &cpu6502::___, &cpu6502::___, 0 }, // 0x17
-        { CLC_IMP, "CLC", &cpu6502::CLC, &cpu6502::IMP, 2 }, // 0x18
-        { ORA_ABY, "ORA", &cpu6502::ORA, &cpu6502::ABY, 4 }, // 0x19
-        { _0x1A__, "x1A", &cpu6502::___, &cpu6502::___, 0 }, // 0x1A
-        { _0x1B__, "x1B", &cpu6502::___, &cpu6502::___, 0 }, // 0x1B
-        { _0x1C__, "x1C", &cpu6502::___, &cpu6502::___, 0 }, // 0x1C
-        { ORA_ABX, "ORA", &cpu6502::ORA, &cpu6502::ABX, 4 }, // 0x1D
-        { ASL_ABX, "ASL", &cpu6502::ASL, &cpu6502::ABX, 7 }, // 0x1E
-        { _0x1F__, "x1F", &cpu6502::___, &cpu6502::___, 0 }, // 0x1F
-        { JSR____, "JSR", &cpu6502::JSR, &cpu6502::___, 6 }, // 0x20
-        { AND_IDX, "AND", &cpu6502::AND, &cpu6502::IDX, 6 }, // 0x21
-        { _0x22__, "x22", &cpu6502::___, &cpu6502::___, 0 }, // 0x22
-        { _0x23__, "x23", &cpu6502::___, &cpu6502::___, 0 }, // 0x23
-        { BIT_ZPG, "BIT", &cpu6502::BIT, &cpu6502::ZPG, 3 }, // 0x24
-        { AND_ZPG, "AND", &cpu6502::AND, &cpu6502::ZPG, 3 }, // 0x25
-        { ROL_ZPG, "ROL", &cpu6502::ROL, &cpu6502::ZPG, 5 }, // 0x26
-        { _0x27__, "x27", &cpu6502::___, &cpu6502::___, 0 }, // 0x27
-        { PLP_IMP, "PLP", &cpu6502::PLP, &cpu6502::IMP, 4 }, // 0x28
-        { AND_IMM, "AND", &cpu6502::AND, &cpu6502::IMM, 2 }, // 0x29
-        { ROL_ACC, "ROL", &cpu6502::ROL, &cpu6502::ACC, 2 }, // 0x2A
-        { _0x2B__, "x2B", &cpu6502::___, &cpu6502::___, 0 }, // 0x2B
-        { BIT_ABS, "BIT", &cpu6502::BIT, &cpu6502::ABS, 4 }, // 0x2C
-        { AND_ABS, "AND", &cpu6502::AND, &cpu6502::ABS, 4 }, // 0x2D
-        { ROL_ABS, "ROL", &cpu6502::ROL, &cpu6502::ABS, 6 }, // 0x2E
-        { _0x2F__, "x2F", &cpu6502::___, &cpu6502::___, 0 }, // 0x2F
-        { BMI____, "BMI", &cpu6502::BMI, &cpu6502::___, 2 }, // 0x30
-        { AND_IDY, "AND", &cpu6502::AND, &cpu6502::IDY, 5 }, // 0x31
-        { _0x32__, "x32", &cpu6502::___, &cpu6502::___, 0 }, // 0x32
-        { _0x33__, "x33", &cpu6502::___, &cpu6502::___, 0 }, // 0x33
-        { _0x34__, "x34", &cpu6502::___, &cpu6502::___, 0 }, // 0x34
-        { AND_ZPX, "AND", &cpu6502::AND, &cpu6502::ZPX, 4 }, // 0x35
-        { ROL_ZPX, "ROL", &cpu6502::ROL, &cpu6502::ZPX, 6 }, // 0x36
-        { _0x37__, "x37", &cpu6502::___, &cpu6502::___, 0 }, // 0x37
-        { SEC_IMP, "SEC", &cpu6502::SEC, &cpu6502::IMP, 2 }, // 0x38
-        { AND_ABY, "AND", &cpu6502::AND, &cpu6502::ABY, 4 }, // 0x39
-        { _0x3A__, "x3A", &cpu6502::___, &cpu6502::___, 0 }, // 0x3A
-        { _0x3B__, "x3B", &cpu6502::___, &cpu6502::___, 0 }, // 0x3B
-        { _0x3C__, "x3C", &cpu6502::___, &cpu6502::___, 0 }, // 0x3C
-        { AND_ABX, "AND", &cpu6502::AND, &cpu6502::ABX, 4 }, // 0x3D
-        { ROL_ABX, "ROL", &cpu6502::ROL, &cpu6502::ABX, 7 }, // 0x3E
-        { _0x3F__, "x3F", &cpu6502::___, &cpu6502::___, 0 }, // 0x3F
-        { RTI_IMP, "RTI", &cpu6502::RTI, &cpu6502::IMP, 6 }, // 0x40
-        { EOR_IDX, "EOR", &cpu6502::EOR, &cpu6502::IDX, 6 }, // 0x41
-        { _0x42__, "x42", &cpu6502::___, &cpu6502::___, 0 }, // 0x42
-        { _0x43__, "x43", &cpu6502::___, &cpu6502::___, 0 }, // 0x43
-        { _0x44__, "x44", &cpu6502::___, &cpu6502::___, 0 }, // 0x44
-        { EOR_ZPG, "EOR", &cpu6502::EOR, &cpu6502::ZPG, 3 }, // 0x45
-        { LSR_ZPG, "LSR", &cpu6502::LSR, &cpu6502::ZPG, 5 }, // 0x46
-        { _0x47__, "x47", &cpu6502::___, &cpu6502::___, 0 }, // 0x47
-        { PHA_IMP, "PHA", &cpu6502::PHA, &cpu6502::IMP, 3 }, // 0x48
-        { EOR_IMM, "EOR", &cpu6502::EOR, &cpu6502::IMM, 2 }, // 0x49
-        { LSR_ACC, "LSR", &cpu6502::LSR, &cpu6502::ACC, 2 }, // 0x4A
-        { _0x4B__, "x4B", &cpu6502::___, &cpu6502::___, 0 }, // 0x4B
-        { JMP_ABS, "JMP", &cpu6502::JMP, &cpu6502::ABS, 3 }, // 0x4C
-        { EOR_ABS, "EOR", &cpu6502::EOR, &cpu6502::ABS, 4 }, // 0x4D
-        { LSR_ABS, "LSR", &cpu6502::LSR, &cpu6502::ABS, 6 }, // 0x4E
-        { _0x4F__, "x4F", &cpu6502::___, &cpu6502::___, 0 }, // 0x4F
-        { BVC____, "BVC", &cpu6502::BVC, &cpu6502::___, 2 }, // 0x50
-        { EOR_IDY, "EOR", &cpu6502::EOR, &cpu6502::IDY, 5 }, // 0x51
-        { _0x52__, "x52", &cpu6502::___, &cpu6502::___, 0 }, // 0x52
-        { _0x53__, "x53", &cpu6502::___, &cpu6502::___, 0 }, // 0x53
-        { _0x54__, "x54", &cpu6502::___, &cpu6502::___, 0 }, // 0x54
-        { EOR_ZPX, "EOR", &cpu6502::EOR, &cpu6502::ZPX, 4 }, // 0x55
-        { LSR_ZPX, "LSR", &cpu6502::LSR, &cpu6502::ZPX, 6 }, // 0x56
-        { _0x57__, "x57", &cpu6502::___, &cpu6502::___, 0 }, // 0x57
-        { CLI_IMP, "CLI", &cpu6502::CLI, &cpu6502::IMP, 2 }, // 0x58
-        { EOR_ABY, "EOR", &cpu6502::EOR, &cpu6502::ABY, 4 }, // 0x59
-        { _0x5A__, "x5A", &cpu6502::___, &cpu6502::___, 0 }, // 0x5A
-        { _0x5B__, "x5B", &cpu6502::___, &cpu6502::___, 0 }, // 0x5B
-        { _0x5C__, "x5C", &cpu6502::___, &cpu6502::___, 0 }, // 0x5C
-        { EOR_ABX, "EOR", &cpu6502::EOR, &cpu6502::ABX, 4 }, // 0x5D
-        { LSR_ABX, "LSR", &cpu6502::LSR, &cpu6502::ABX, 7 }, // 0x5E
-        { _0x5F__, "x5F", &cpu6502::___, &cpu6502::___, 0 }, // 0x5F
-        { RTS_IMP, "RTS", &cpu6502::RTS, &cpu6502::IMP, 6 }, // 0x60
-        { ADC_IDX, "ADC", &cpu6502::ADC, &cpu6502::IDX, 6 }, // 0x61
-        { _0x62__, "x62", &cpu6502::___, &cpu6502::___, 0 }, // 0x62
-        { _0x63__, "x63", &cpu6502::___, &cpu6502::___, 0 }, // 0x63
-        { _0x64__, "x64", &cpu6502::___, &cpu6502::___, 0 }, // 0x64
-        { ADC_ZPG, "ADC", &cpu6502::ADC, &cpu6502::ZPG, 3 }, // 0x65
-        { ROR_ZPG, "ROR", &cpu6502::ROR, &cpu6502::ZPG, 5 }, // 0x66
-        { _0x67__, "x67", &cpu6502::___, &cpu6502::___, 0 }, // 0x67
-        { PLA_IMP, "PLA", &cpu6502::PLA, &cpu6502::IMP, 4 }, // 0x68
-        { ADC_IMM, "ADC", &cpu6502::ADC, &cpu6502::IMM, 2 }, // 0x69
-        { ROR_ACC, "ROR", &cpu6502::ROR, &cpu6502::ACC, 2 }, // 0x6A
-        { _0x6B__, "x6B", &cpu6502::___, &cpu6502::___, 0 }, // 0x6B
-        { JMP_IND, "JMP", &cpu6502::JMP, &cpu6502::IND, 5 }, // 0x6C
-        { ADC_ABS, "ADC", &cpu6502::ADC, &cpu6502::ABS, 4 }, // 0x6D
-        { ROR_ABS, "ROR", &cpu6502::ROR, &cpu6502::ABS, 6 }, // 0x6E
-        { _0x6F__, "x6F", &cpu6502::___, &cpu6502::___, 0 }, // 0x6F
-        { BVS____, "BVS", &cpu6502::BVS, &cpu6502::___, 2 }, // 0x70
-        { ADC_IDY, "ADC", &cpu6502::ADC, &cpu6502::IDY, 5 }, // 0x71
-        { _0x72__, "x72", &cpu6502::___, &cpu6502::___, 0 }, // 0x72
-        { _0x73__, "x73", &cpu6502::___, &cpu6502::___, 0 }, // 0x73
-        { _0x74__, "x74", &cpu6502::___, &cpu6502::___, 0 }, // 0x74
-        { ADC_ZPX, "ADC", &cpu6502::ADC, &cpu6502::ZPX, 4 }, // 0x75
-        { ROR_ZPX, "ROR", &cpu6502::ROR, &cpu6502::ZPX, 6 }, // 0x76
-        { _0x77__, "x77", &cpu6502::___, &cpu6502::___, 0 }, // 0x77
-        { SEI_IMP, "SEI", &cpu6502::SEI, &cpu6502::IMP, 2 }, // 0x78
-        { ADC_ABY, "ADC", &cpu6502::ADC, &cpu6502::ABY, 4 }, // 0x79
-        { _0x7A__, "x7A", &cpu6502::___, &cpu6502::___, 0 }, // 0x7A
-        { _0x7B__, "x7B", &cpu6502::___, &cpu6502::___, 0 }, // 0x7B
-        { _0x7C__, "x7C", &cpu6502::___, &cpu6502::___, 0 }, // 0x7C
-        { ADC_ABX, "ADC", &cpu6502::ADC, &cpu6502::ABX, 4 }, // 0x7D
-        { ROR_ABX, "ROR", &cpu6502::ROR, &cpu6502::ABX, 7 }, // 0x7E
-        { _0x7F__, "x7F", &cpu6502::___, &cpu6502::___, 0 }, // 0x7F
-        { _0x80__, "x80", &cpu6502::___, &cpu6502::___, 0 }, // 0x80
-        { STA_IDX, "STA", &cpu6502::STA, &cpu6502::IDX, 6 }, // 0x81
-        { _0x82__, "x82", &cpu6502::___, &cpu6502::___, 0 }, // 0x82
-        { _0x83__, "x83", &cpu6502::___, &cpu6502::___, 0 }, // 0x83
-        { STY_ZPG, "STY", &cpu6502::STY, &cpu6502::ZPG, 3 }, // 0x84
-        { STA_ZPG, "STA", &cpu6502::STA, &cpu6502::ZPG, 3 }, // 0x85
-        { STX_ZPG, "STX", &cpu6502::STX, &cpu6502::ZPG, 3 }, // 0x86
-        { _0x87__, "x87", &cpu6502::___, &cpu6502::___, 0 }, // 0x87
-        { DEY_IMP, "DEY", &cpu6502::DEY, &cpu6502::IMP, 2 }, // 0x88
-        { _0x89__, "x89", &cpu6502::___, &cpu6502::___, 0 }, // 0x89
-        { TXA_IMP, "TXA", &cpu6502::TXA, &cpu6502::IMP, 2 }, // 0x8A
-        { _0x8B__, "x8B", &cpu6502::___, &cpu6502::___, 0 }, // 0x8B
-        { STY_ABS, "STY", &cpu6502::STY, &cpu6502::ABS, 4 }, // 0x8C
-        { STA_ABS, "STA", &cpu6502::STA, &cpu6502::ABS, 4 }, // 0x8D
-        { STX_ABS, "STX", &cpu6502::STX, &cpu6502::ABS, 4 }, // 0x8E
-        { _0x8F__, "x8F", &cpu6502::___, &cpu6502::___, 0 }, // 0x8F
-        { BCC____, "BCC", &cpu6502::BCC, &cpu6502::___, 2 }, // 0x90
-        { STA_IDY, "STA", &cpu6502::STA, &cpu6502::IDY, 6 }, // 0x91
-        { _0x92__, "x92", &cpu6502::___, &cpu6502::___, 0 }, // 0x92
-        { _0x93__, "x93", &cpu6502::___, &cpu6502::___, 0 }, // 0x93
-        { STY_ZPX, "STY", &cpu6502::STY, &cpu6502::ZPX, 4 }, // 0x94
-        { STA_ZPX, "STA", &cpu6502::STA, &cpu6502::ZPX, 4 }, // 0x95
-        { STX_ZPY, "STX", &cpu6502::STX, &cpu6502::ZPY, 4 }, // 0x96
-        { _0x97__, "x97", &cpu6502::___, &cpu6502::___, 0 }, // 0x97
-        { TYA_IMP, "TYA", &cpu6502::TYA, &cpu6502::IMP, 2 }, // 0x98
-        { STA_ABY, "STA", &cpu6502::STA, &cpu6502::ABY, 5 }, // 0x99
-        { TXS_IMP, "TXS", &cpu6502::TXS, &cpu6502::IMP, 2 }, // 0x9A
-        { _0x9B__, "x9B", &cpu6502::___, &cpu6502::___, 0 }, // 0x9B
-        { _0x9C__, "x9C", &cpu6502::___, &cpu6502::___, 0 }, // 0x9C
-        { STA_ABX, "STA", &cpu6502::STA, &cpu6502::ABX, 5 }, // 0x9D
-        { _0x9E__, "x9E", &cpu6502::___, &cpu6502::___, 0 }, // 0x9E
-        { _0x9F__, "x9F", &cpu6502::___, &cpu6502::___, 0 }, // 0x9F
-        { LDY_IMM, "LDY", &cpu6502::LDY, &cpu6502::IMM, 2 }, // 0xA0
-        { LDA_IDX, "LDA", &cpu6502::LDA, &cpu6502::IDX, 6 }, // 0xA1
-        { LDX_IMM, "LDX", &cpu6502::LDX, &cpu6502::IMM, 2 }, // 0xA2
-        { _0xA3__, "xA3", &cpu6502::___, &cpu6502::___, 0 }, // 0xA3
-        { LDY_ZPG, "LDY", &cpu6502::LDY, &cpu6502::ZPG, 3 }, // 0xA4
-        { LDA_ZPG, "LDA", &cpu6502::LDA, &cpu6502::ZPG, 3 }, // 0xA5
-        { LDX_ZPG, "LDX", &cpu6502::LDX, &cpu6502::ZPG, 3 }, // 0xA6
-        { _0xA7__, "xA7", &cpu6502::___, &cpu6502::___, 0 }, // 0xA7
-        { TAY_IMP, "TAY", &cpu6502::TAY, &cpu6502::IMP, 2 }, // 0xA8
-        { LDA_IMM, "LDA", &cpu6502::LDA, &cpu6502::IMM, 2 }, // 0xA9
-        { TAX_IMP, "TAX", &cpu6502::TAX, &cpu6502::IMP, 2 }, // 0xAA
-        { _0xAB__, "xAB", &cpu6502::___, &cpu6502::___, 0 }, // 0xAB
-        { LDY_ABS, "LDY", &cpu6502::LDY, &cpu6502::ABS, 4 }, // 0xAC
-        { LDA_ABS, "LDA", &cpu6502::LDA, &cpu6502::ABS, 4 }, // 0xAD
-        { LDX_ABS, "LDX", &cpu6502::LDX, &cpu6502::ABS, 4 }, // 0xAE
-        { _0xAF__, "xAF", &cpu6502::___, &cpu6502::___, 0 }, // 0xAF
-        { BCS____, "BCS", &cpu6502::BCS, &cpu6502::___, 2 }, // 0xB0
-        { LDA_IDY, "LDA", &cpu6502::LDA, &cpu6502::IDY, 5 }, // 0xB1
-        { _0xB2__, "xB2", &cpu6502::___, &cpu6502::___, 0 }, // 0xB2
-        { _0xB3__, "xB3", &cpu6502::___, &cpu6502::___, 0 }, // 0xB3
-        { LDY_ZPX, "LDY", &cpu6502::LDY, &cpu6502::ZPX, 4 }, // 0xB4
-        { LDA_ZPX, "LDA", &cpu6502::LDA, &cpu6502::ZPX, 4 }, // 0xB5
-        { LDX_ZPY, "LDX", &cpu6502::LDX, &cpu6502::ZPY, 4 }, // 0xB6
-        { _0xB7__, "xB7", &cpu6502::___, &cpu6502::___, 0 }, // 0xB7
-        { CLV_IMP, "CLV", &cpu6502::CLV, &cpu6502::IMP, 2 }, // 0xB8
-        { LDA_ABY, "LDA", &cpu6502::LDA, &cpu6502::ABY, 4 }, // 0xB9
-        { TSX_IMP, "TSX", &cpu6502::TSX, &cpu6502::IMP, 2 }, // 0xBA
-        { _0xBB__, "xBB", &cpu6502::___, &cpu6502::___, 0 }, // 0xBB
-        { LDY_ABX, "LDY", &cpu6502::LDY, &cpu6502::ABX, 4 }, // 0xBC
-        { LDA_ABX, "LDA", &cpu6502::LDA, &cpu6502::ABX, 4 }, // 0xBD
-        { LDX_ABY, "LDX", &cpu6502::LDX, &cpu6502::ABY, 4 }, // 0xBE
-        { _0xBF__, "xBF", &cpu6502::___, &cpu6502::___, 0 }, // 0xBF
-        { CPY_IMM, "CPY", &cpu6502::CPY, &cpu6502::IMM, 2 }, // 0xC0
-        { CMP_IDX, "CMP", &cpu6502::CMP, &cpu6502::IDX, 6 }, // 0xC1
-        { _0xC2__, "xC2", &cpu6502::___, &cpu6502::___, 0 }, // 0xC2
-        { _0xC3__, "xC3", &cpu6502::___, &cpu6502::___, 0 }, // 0xC3
-        { CPY_ZPG, "CPY", &cpu6502::CPY, &cpu6502::ZPG, 3 }, // 0xC4
-        { CMP_ZPG, "CMP", &cpu6502::CMP, &cpu6502::ZPG, 3 }, // 0xC5
-        { DEC_ZPG, "DEC", &cpu6502::DEC, &cpu6502::ZPG, 5 }, // 0xC6
-        { _0xC7__, "xC7", &cpu6502::___, &cpu6502::___, 0 }, // 0xC7
-        { INY_IMP, "INY", &cpu6502::INY, &cpu6502::IMP, 2 }, // 0xC8
-        { CMP_IMM, "CMP", &cpu6502::CMP, &cpu6502::IMM, 2 }, // 0xC9
-        { DEX_IMP, "DEX", &cpu6502::DEX, &cpu6502::IMP, 2 }, // 0xCA
-        { _0xCB__, "xCB", &cpu6502::___, &cpu6502::___, 0 }, // 0xCB
-        { CPY_ABS, "CPY", &cpu6502::CPY, &cpu6502::ABS, 4 }, // 0xCC
-        { CMP_ABS, "CMP", &cpu6502::CMP, &cpu6502::ABS, 4 }, // 0xCD
-        { DEC_ABS, "DEC", &cpu6502::DEC, &cpu6502::ABS, 6 }, // 0xCE
-        { _0xCF__, "xCF", &cpu6502::___, &cpu6502::___, 0 }, // 0xCF
-        { BNE____, "BNE", &cpu6502::BNE, &cpu6502::___, 2 }, // 0xD0
-        { CMP_IDY, "CMP", &cpu6502::CMP, &cpu6502::IDY, 5 }, // 0xD1
-        { _0xD2__, "xD2", &cpu6502::___, &cpu6502::___, 0 }, // 0xD2
-        { _0xD3__, "xD3", &cpu6502::___, &cpu6502::___, 0 }, // 0xD3
-        { _0xD4__, "xD4", &cpu6502::___, &cpu6502::___, 0 }, // 0xD4
-        { CMP_ZPX, "CMP", &cpu6502::CMP, &cpu6502::ZPX, 4 }, // 0xD5
-        { DEC_ZPX, "DEC", &cpu6502::DEC, &cpu6502::ZPX, 6 }, // 0xD6
-        { _0xD7__, "xD7", &cpu6502::___, &cpu6502::___, 0 }, // 0xD7
-        { CLD_IMP, "CLD", &cpu6502::CLD, &cpu6502::IMP, 2 }, // 0xD8
-        { CMP_ABY, "CMP", &cpu6502::CMP, &cpu6502::ABY, 4 }, // 0xD9
-        { _0xDA__, "xDA", &cpu6502::___, &cpu6502::___, 0 }, // 0xDA
-        { _0xDB__, "xDB", &cpu6502::___, &cpu6502::___, 0 }, // 0xDB
-        { _0xDC__, "xDC", &cpu6502::___, &cpu6502::___, 0 }, // 0xDC
-        { CMP_ABX, "CMP", &cpu6502::CMP, &cpu6502::ABX, 4 }, // 0xDD
-        { DEC_ABX, "DEC", &cpu6502::DEC, &cpu6502::ABX, 7 }, // 0xDE
-        { _0xDF__, "xDF", &cpu6502::___, &cpu6502::___, 0 }, // 0xDF
-        { CPX_IMM, "CPX", &cpu6502::CPX, &cpu6502::IMM, 2 }, // 0xE0
-        { SBC_IDX, "SBC", &cpu6502::SBC, &cpu6502::IDX, 6 }, // 0xE1
-        { _0xE2__, "xE2", &cpu6502::___, &cpu6502::___, 0 }, // 0xE2
-        { _0xE3__, "xE3", &cpu6502::___, &cpu6502::___, 0 }, // 0xE3
-        { CPX_ZPG, "CPX", &cpu6502::CPX, &cpu6502::ZPG, 3 }, // 0xE4
-        { SBC_ZPG, "SBC", &cpu6502::SBC, &cpu6502::ZPG, 3 }, // 0xE5
-        { INC_ZPG, "INC", &cpu6502::INC, &cpu6502::ZPG, 5 }, // 0xE6
-        { _0xE7__, "xE7", &cpu6502::___, &cpu6502::___, 0 }, // 0xE7
-        { INX_IMP, "INX", &cpu6502::INX, &cpu6502::IMP, 2 }, // 0xE8
-        { SBC_IMM, "SBC", &cpu6502::SBC, &cpu6502::IMM, 2 }, // 0xE9
-        { NOP_IMP, "NOP", &cpu6502::NOP, &cpu6502::IMP, 2 }, // 0xEA
-        { _0xEB__, "xEB", &cpu6502::___, &cpu6502::___, 2 }, // 0xEB
-        { CPX_ABS, "CPX", &cpu6502::CPX, &cpu6502::ABS, 4 }, // 0xEC
-        { SBC_ABS, "SBC", &cpu6502::SBC, &cpu6502::ABS, 4 }, // 0xED
-        { INC_ABS, "INC", &cpu6502::INC, &cpu6502::ABS, 6 }, // 0xEE
-        { _0xEF__, "xEF", &cpu6502::___, &cpu6502::___, 0 }, // 0xEF
-        { BEQ____, "BEQ", &cpu6502::BEQ, &cpu6502::___, 2 }, // 0xF0
-        { SBC_IDY, "SBC", &cpu6502::SBC, &cpu6502::IDY, 5 }, // 0xF1
-        { _0xF2__, "xF2", &cpu6502::___, &cpu6502::___, 0 }, // 0xF2
-        { _0xF3__, "xF3", &cpu6502::___, &cpu6502::___, 0 }, // 0xF3
-        { _0xF4__, "xF4", &cpu6502::___, &cpu6502::___, 0 }, // 0xF4
-        { SBC_ZPX, "SBC", &cpu6502::SBC, &cpu6502::ZPX, 4 }, // 0xF5
-        { INC_ZPX, "INC", &cpu6502::INC, &cpu6502::ZPX, 6 }, // 0xF6
-        { _0xF7__, "xF7", &cpu6502::___, &cpu6502::___, 0 }, // 0xF7
-        { SED_IMP, "SED", &cpu6502::SED, &cpu6502::IMP, 2 }, // 0xF8
-        { SBC_ABY, "SBC", &cpu6502::SBC, &cpu6502::ABY, 4 }, // 0xF9
-        { _0xFA__, "xFA", &cpu6502::___, &cpu6502::___, 2 }, // 0xFA
-        { _0xFB__, "xFB", &cpu6502::___, &cpu6502::___, 0 }, // 0xFB
-        { _0xFC__, "xFC", &cpu6502::___, &cpu6502::___, 0 }, // 0xFC
-        { SBC_ABX, "SBC", &cpu6502::SBC, &cpu6502::ABX, 4 }, // 0xFD
-        { INC_ABX, "INC", &cpu6502::INC, &cpu6502::ABX, 7 }, // 0xFE
-        { _0xFF__, "xFF", &cpu6502::___, &cpu6502::___, 0 }, // 0xFF
-    } };
+    static const std::array<instruction_t, 256> instructions;
 
 private:
     enum class cycle_mode {
@@ -690,9 +571,206 @@ private:
         always
     };
 
-    cpu6502::cycle_mode add_cycle = cpu6502::cycle_mode::never;
+    cycle_mode add_cycle = cycle_mode::never;
     bool add_carry = false;
     bool acc_addressing = false;
+    uint8_t extra_cycles {}; // page crossing and branch penalties
+    size_t block_cycles {}; // base cycles of the block instructions already run, not on the clock yet
+    static constexpr uint8_t max_extra_cycles = 2; // a taken branch to another page
+
+    struct dispatch_t {
+        handler_t handler; // fused addressing + operation
+        uint8_t cycles; // base cycle count
+        uint8_t length; // opcode and operand bytes
+        bool ends_block; // control flow leaves the straight-line path
+        bool idle_safe; // may run in an idle loop, see build_block
+    };
+
+    // hot per-opcode data, generated from instructions
+    static const std::array<dispatch_t, 256> dispatch;
+
+    template <size_t... index>
+    static constexpr std::array<dispatch_t, 256> make_dispatch(std::index_sequence<index...>);
+
+    template <void (basic_cpu6502::*addressing)(), void (basic_cpu6502::*operation)()>
+    static void fused(basic_cpu6502& cpu) noexcept;
+
+    static constexpr uint8_t length(const instruction_t& instruction);
+    static constexpr bool ends_block(const instruction_t& instruction);
+    static constexpr bool idle_safe(const instruction_t& instruction);
+
+    struct decoded_t {
+        handler_t handler;
+        uint32_t generation; // valid while equal to the decode generation of its page
+        uint16_t operand; // the operand bytes following the opcode, zero past the instruction's length
+        uint8_t oc;
+        uint8_t cycles;
+    };
+
+    static constexpr uint8_t page_code = 1 << 0; // page holds decoded instructions
+    static constexpr uint8_t page_clean = 1 << 1; // a dirty_tracking bus hasn't seen a write to the page yet
+    static constexpr uint8_t page_journal = 1 << 2; // writes go to the journal
+    static constexpr uint8_t page_read_watch = 1 << 3; // holds a read watchpoint, reads check the bitmap
+    static constexpr uint8_t page_write_watch = 1 << 4; // holds a write watchpoint
+
+    std::array<uint8_t, 256> page_flags {}; // any flag set sends writes to the page through flagged_write
+    uint32_t clean_marks {}; // the bus's marks when page_clean was last set
+    struct decode_cache_t {
+        std::array<decoded_t, 64 * 1024> entries; // keyed by PC
+        std::array<uint32_t, 256> generations {}; // per page, remapping a page only replaces its generation
+    };
+
+    std::unique_ptr<decode_cache_t> decode_cache;
+    uint32_t cache_generation = 1; // the last one handed out
+    uint32_t operand {}; // bytes still to fetch, lowest first
+    bool predecoded = false;
+
+    static constexpr uint8_t max_block_size = 32;
+
+    struct block_op_t {
+        handler_t handler;
+        uint32_t operand; // operand bytes of both instructions when fused
+        uint8_t oc;
+        uint8_t cycles;
+        uint8_t tail_cycles; // base cycles of the fused second instruction
+    };
+
+    struct block_t {
+        std::array<block_op_t, max_block_size> ops;
+        std::array<block_t*, 2> next {}; // chained successors, checked against PC before use
+        std::array<uint32_t, 2> generations {}; // page generations the block was built against
+        std::array<uint8_t, 2> pages {}; // first and last page the block's bytes touch
+        uint16_t start {};
+        uint16_t end {}; // address after the last instruction
+        uint16_t cycles {}; // sum of base cycles
+        uint16_t max_cycles {}; // with every page crossing and branch penalty, bounds a run against its deadline
+        uint8_t size {}; // zero until built
+        uint8_t hits {}; // executions counted towards translation
+        bool idle = false; // branches back to start and only loads, compares and transfers on the way
+        uint8_t trap {}; // length of a final jump or branch to itself, zero without one
+        jit_x64::entry_t native {};
+    };
+
+    struct block_cache_t {
+        std::array<std::unique_ptr<block_t>, 64 * 1024> blocks; // keyed by start address, never moved once made
+        std::array<uint32_t, 256> generations {}; // bumped on every write to a code page
+    };
+
+    std::unique_ptr<block_cache_t> block_cache;
+    bool code_written = false; // set by flagged_write, polled between block instructions
+    uint16_t stop_address {}; // of the current run, fused pairs stop halfway on it
+    bool pair_split = false; // a fused pair ran only its first instruction
+
+    // superinstructions picked from top_bigrams, block mode runs them as one op
+    struct pair_t {
+        opcode first;
+        opcode second;
+        handler_t handler;
+    };
+
+    static const std::array<pair_t, 6> pairs;
+
+    template <opcode first, opcode second>
+    static void fused_pair(basic_cpu6502& cpu) noexcept;
+
+    std::unique_ptr<std::array<uint64_t, 256 * 256>> bigrams;
+    uint8_t last_oc {};
+
+    void count_bigram(uint8_t next)
+    {
+        (*bigrams)[(last_oc << 8) | next]++;
+        last_oc = next;
+    }
+
+    std::unique_ptr<write_journal> journal;
+    bool servicing = false; // IRQ or NMI pushing, PC is the return address then
+
+    std::unique_ptr<trace_ring> trace;
+
+    std::unique_ptr<breakpoint_set> breakpoints;
+    stop_reason watch_hit {}; // of the pending watchpoint
+    uint16_t watch_pc {};
+    uint16_t resume_pc {}; // where the run started, its first instruction runs
+    bool resuming = false;
+
+    bool is_execute_breakpoint(uint16_t address) const { return breakpoints && breakpoints->contains(break_kind::execute, address); }
+    bool at_breakpoint(); // PC is on an execute breakpoint other than the run's first instruction
+    void watched(break_kind kind); // a watched page was read or written
+    stop_reason take_watch(uint16_t& pc);
+    uint16_t instruction_pc() const;
+
+    static constexpr uint8_t jit_threshold = 16;
+
+    std::unique_ptr<jit_x64> jit;
+    uint16_t jit_stop {}; // translations compare bus addresses against it
+
+    // N and Z as the byte they were computed from, C and V unpacked, the core works on these
+    // and packs them into P only when the status byte is pushed, handed over or returned
+    struct lazy_flags_t {
+        uint8_t n; // bit 7
+        uint8_t z; // zero when set
+        bool c;
+        bool v;
+    };
+
+    lazy_flags_t flags { 0, 1, false, false };
+    bool flags_unpacked = false; // from run or execute loading flags until they store them back into P
+
+    void set_nz(uint8_t result)
+    {
+        flags.n = result;
+        flags.z = result;
+    }
+
+    void load_flags();
+    void store_flags();
+    void step() noexcept; // one instruction, callers poll interrupts first and run's loop inlines it
+
+    uint32_t next_generation();
+
+    const decoded_t* predecode(uint16_t pc); // null when the instruction has bytes on a device page
+    bool peek_code(uint16_t address, uint8_t& byte);
+    void begin_instruction(uint8_t next);
+    void execute_decoded(handler_t handler, uint32_t bytes, uint8_t next);
+    uint8_t fetch();
+    uint8_t read_code(); // opcode and operand fetches, read watchpoints don't see them
+    void flagged_write();
+    void journal_write();
+    void watch_clean_pages(); // sets page_clean from a dirty_tracking bus after it marked pages clean
+
+    bool is_valid(const block_t& block) const;
+    block_t& lookup_block(uint16_t pc);
+    void build_block(block_t& block, uint16_t pc);
+    block_t& successor(block_t& block);
+    bool execute_block(const block_t& block, uint16_t stop) noexcept;
+    void drop_blocks();
+
+    // what an idle loop pass may change, equal before and after a pass means every further pass is the same
+    struct idle_state_t {
+        uint8_t A;
+        uint8_t X;
+        uint8_t Y;
+        lazy_flags_t flags;
+        size_t cycles;
+
+        bool same_registers(const idle_state_t& other) const
+        {
+            return A == other.A && X == other.X && Y == other.Y
+                && flags.n == other.flags.n && flags.z == other.flags.z
+                && flags.c == other.flags.c && flags.v == other.flags.v;
+        }
+    };
+
+    std::optional<stop_reason> check_block(const block_t& block, const stop_conditions& conditions, uint16_t& pc);
+    std::optional<stop_reason> checked_step(const stop_conditions& conditions, size_t& instructions, uint16_t& pc);
+
+    idle_state_t idle_state();
+    bool reads_only_ram(const block_t& block);
+    void skip_idle(const block_t& block, const idle_state_t& before, size_t deadline) noexcept;
+    size_t idle_cycles {};
+
+    void translate(block_t& block, uint16_t stop);
+    bool execute_native(const block_t& block, uint16_t stop);
 
     void add_register(uint8_t& byte, uint8_t reg);
     void zero_page(uint8_t reg);
@@ -726,7 +804,12 @@ private:
         }
     }
     void branch(bool is_branch);
-    void interrupt(const interrupt_vec& vec);
+    void interrupt(const interrupt_vec& vec, bool brk);
+    bool poll_interrupts();
+    void service_interrupt(const interrupt_vec& vec);
 };
 
+// the virtual interface instantiation, any i_bus and i_clock implementation plugs in at runtime
+using cpu6502 = basic_cpu6502<i_bus, i_clock>;
+
 }
\ No newline at end of file
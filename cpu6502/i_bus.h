@@ -4,6 +4,9 @@
 
 namespace emulator {
 
+// a whole address space of bytes, what bus snapshots copy in one go
+using memory_image = std::array<uint8_t, 64 * 1024>;
+
 class i_bus {
 public:
     virtual void reset() = 0;
@@ -14,4 +17,43 @@ public:
     virtual ~i_bus() = default;
 };
 
-}
\ No newline at end of file
+// anything usable as a bus without going through the i_bus vtable
+template <typename T>
+concept bus_type = requires(T& bus, uint16_t address, uint8_t byte, std::string filepath) {
+    bus.reset();
+    { bus.read(address) } -> std::convertible_to<uint8_t>;
+    bus.write(address, byte);
+    bus.load_file(filepath);
+};
+
+// buses that hand out plain RAM per 256 byte page, used by the jit to bypass read and write,
+// null marks a page every access to must go through the bus
+template <typename T>
+concept ram_bus = bus_type<T> && requires(T& bus, uint8_t page) {
+    { bus.ram_page(page) } -> std::same_as<uint8_t*>;
+};
+
+// buses that hand out what a read of each 256 byte page sees, RAM or ROM,
+// null marks a device page, basic_cpu6502 never decodes ahead through one
+template <typename T>
+concept readable_pages = bus_type<T> && requires(const T& bus, uint8_t page) {
+    { bus.read_page(page) } -> std::same_as<const uint8_t*>;
+};
+
+// buses that report page table changes, basic_cpu6502 hooks in to drop stale decoded code
+template <typename T>
+concept remap_hook = bus_type<T> && requires(T& bus) {
+    bus.on_remap = [](uint8_t, size_t) {};
+};
+
+// buses that track the pages written through write, the jit stores straight into ram_page memory,
+// so basic_cpu6502 flags the clean pages and sends the first store to each through write,
+// marks tells it when pages turned clean again
+template <typename T>
+concept dirty_tracking = ram_bus<T> && requires(T& bus, uint8_t page) {
+    { bus.is_tracking() } -> std::same_as<bool>;
+    { bus.is_dirty(page) } -> std::same_as<bool>;
+    { bus.get_marks() } -> std::convertible_to<uint32_t>;
+};
+
+}
@@ -8,10 +8,23 @@ class i_clock {
 public:
     virtual void reset() = 0;
     virtual void cycle() = 0;
+    virtual void add_cycles(size_t count) = 0;
     virtual size_t get_cycles() = 0;
+    virtual void set_cycles(size_t count) = 0; // jumps to count without waiting, for restoring a saved state
     virtual void set_timing(size_t) = 0;
 
     virtual ~i_clock() = default;
 };
 
+// anything usable as a clock without going through the i_clock vtable
+template <typename T>
+concept clock_type = requires(T& clock, size_t count) {
+    clock.reset();
+    clock.cycle();
+    clock.add_cycles(count);
+    { clock.get_cycles() } -> std::convertible_to<size_t>;
+    clock.set_cycles(count);
+    clock.set_timing(count);
+};
+
 }
\ No newline at end of file
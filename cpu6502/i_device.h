@@ -0,0 +1,16 @@
+#pragma once
+
+#include "types.h"
+
+namespace emulator {
+
+// memory mapped I/O behind a paged_bus, gets the full bus address
+class i_device {
+public:
+    virtual uint8_t read(uint16_t address) = 0;
+    virtual void write(uint16_t address, uint8_t byte) = 0;
+
+    virtual ~i_device() = default;
+};
+
+}
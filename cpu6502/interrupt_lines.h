@@ -0,0 +1,71 @@
+#pragma once
+
+#include "types.h"
+
+namespace emulator {
+
+// the IRQ and NMI inputs of a basic_cpu6502, devices keep a reference to drive them,
+// everything that can interrupt the cpu folds into pending, the one word checked per instruction
+class interrupt_lines {
+public:
+    static constexpr uint8_t pending_irq = 1 << 0; // IRQ asserted and not masked
+    static constexpr uint8_t pending_nmi = 1 << 1; // NMI edge not serviced yet
+    static constexpr uint8_t pending_mask = 1 << 2; // CLI, SEI or PLP changed I, polling catches up after the next instruction
+    static constexpr uint8_t pending_event = 1 << 3; // a scheduler event moved closer, run checks its deadline again
+    static constexpr uint8_t pending_halt = 1 << 4; // the cpu jammed, only reset clears it
+    static constexpr uint8_t pending_watch = 1 << 5; // a watchpoint was hit, run stops after the instruction
+
+    // sees every set_irq and set_nmi call, e.g. input_recorder, not part of a saved cpu_state
+    class observer {
+    public:
+        virtual void lines_changed(const interrupt_lines& lines) = 0;
+
+    protected:
+        ~observer() = default;
+    };
+
+    // level triggered and wired-or, every device asserts and releases its own source bits
+    void set_irq(uint32_t source, bool asserted)
+    {
+        irq_sources = asserted ? irq_sources | source : irq_sources & ~source;
+        update();
+        if (watcher) [[unlikely]]
+            watcher->lines_changed(*this);
+    }
+
+    // edge triggered, going asserted latches one NMI
+    void set_nmi(bool asserted)
+    {
+        if (asserted && !nmi_level)
+            pending |= pending_nmi;
+        nmi_level = asserted;
+        if (watcher) [[unlikely]]
+            watcher->lines_changed(*this);
+    }
+
+    bool irq() const { return irq_sources != 0; }
+    uint32_t get_irq_sources() const { return irq_sources; }
+    bool nmi() const { return nmi_level; }
+
+    // the I flag as polling sees it, kept by the cpu
+    void set_masked(bool masked)
+    {
+        this->masked = masked;
+        update();
+    }
+
+    uint8_t pending {};
+    observer* watcher = nullptr;
+
+private:
+    void update()
+    {
+        pending = (pending & ~pending_irq) | (irq_sources && !masked ? pending_irq : 0);
+    }
+
+    uint32_t irq_sources {};
+    bool nmi_level = false;
+    bool masked = false;
+};
+
+}
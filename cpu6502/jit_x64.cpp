@@ -0,0 +1,1020 @@
+#include "jit_x64.h"
+#include "cpu6502.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define JIT_X64_HOST
+#endif
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace emulator {
+
+namespace {
+
+    enum class operation : uint8_t {
+        none,
+        LDA, LDX, LDY, STA, STX, STY,
+        ORA, AND, EOR, ADC, SBC, CMP, CPX, CPY, BIT,
+        ASL, LSR, ROL, ROR, INC, DEC,
+        INX, INY, DEX, DEY,
+        TAX, TAY, TXA, TYA, TSX, TXS,
+        CLC, SEC, CLI, SEI, CLD, SED, CLV, NOP,
+        PHA, PLA, PHP, PLP,
+        BPL, BMI, BVC, BVS, BCC, BCS, BNE, BEQ, JMP
+    };
+
+    enum class addressing : uint8_t {
+        IMP, ACC, IMM, ZPG, ZPX, ZPY, ABS, ABX, ABY, REL
+    };
+
+    struct translation_t {
+        operation op = operation::none;
+        addressing mode = addressing::IMP;
+    };
+
+    // opcodes the translator handles, everything else goes back to the interpreter
+    constexpr std::array<translation_t, 256> make_translations()
+    {
+        using oc = cpu6502_base;
+        using op = operation;
+        using am = addressing;
+
+        std::array<translation_t, 256> table {};
+        auto set = [&](oc::opcode code, op operation, am mode) { table[code] = { operation, mode }; };
+
+        set(oc::LDA_IMM, op::LDA, am::IMM);
+        set(oc::LDA_ZPG, op::LDA, am::ZPG);
+        set(oc::LDA_ZPX, op::LDA, am::ZPX);
+        set(oc::LDA_ABS, op::LDA, am::ABS);
+        set(oc::LDA_ABX, op::LDA, am::ABX);
+        set(oc::LDA_ABY, op::LDA, am::ABY);
+        set(oc::LDX_IMM, op::LDX, am::IMM);
+        set(oc::LDX_ZPG, op::LDX, am::ZPG);
+        set(oc::LDX_ZPY, op::LDX, am::ZPY);
+        set(oc::LDX_ABS, op::LDX, am::ABS);
+        set(oc::LDX_ABY, op::LDX, am::ABY);
+        set(oc::LDY_IMM, op::LDY, am::IMM);
+        set(oc::LDY_ZPG, op::LDY, am::ZPG);
+        set(oc::LDY_ZPX, op::LDY, am::ZPX);
+        set(oc::LDY_ABS, op::LDY, am::ABS);
+        set(oc::LDY_ABX, op::LDY, am::ABX);
+
+        set(oc::STA_ZPG, op::STA, am::ZPG);
+        set(oc::STA_ZPX, op::STA, am::ZPX);
+        set(oc::STA_ABS, op::STA, am::ABS);
+        set(oc::STA_ABX, op::STA, am::ABX);
+        set(oc::STA_ABY, op::STA, am::ABY);
+        set(oc::STX_ZPG, op::STX, am::ZPG);
+        set(oc::STX_ZPY, op::STX, am::ZPY);
+        set(oc::STX_ABS, op::STX, am::ABS);
+        set(oc::STY_ZPG, op::STY, am::ZPG);
+        set(oc::STY_ZPX, op::STY, am::ZPX);
+        set(oc::STY_ABS, op::STY, am::ABS);
+
+        const std::array<std::pair<op, std::array<oc::opcode, 6>>, 6> alu { {
+            { op::ORA, { oc::ORA_IMM, oc::ORA_ZPG, oc::ORA_ZPX, oc::ORA_ABS, oc::ORA_ABX, oc::ORA_ABY } },
+            { op::AND, { oc::AND_IMM, oc::AND_ZPG, oc::AND_ZPX, oc::AND_ABS, oc::AND_ABX, oc::AND_ABY } },
+            { op::EOR, { oc::EOR_IMM, oc::EOR_ZPG, oc::EOR_ZPX, oc::EOR_ABS, oc::EOR_ABX, oc::EOR_ABY } },
+            { op::ADC, { oc::ADC_IMM, oc::ADC_ZPG, oc::ADC_ZPX, oc::ADC_ABS, oc::ADC_ABX, oc::ADC_ABY } },
+            { op::SBC, { oc::SBC_IMM, oc::SBC_ZPG, oc::SBC_ZPX, oc::SBC_ABS, oc::SBC_ABX, oc::SBC_ABY } },
+            { op::CMP, { oc::CMP_IMM, oc::CMP_ZPG, oc::CMP_ZPX, oc::CMP_ABS, oc::CMP_ABX, oc::CMP_ABY } },
+        } };
+        for (const auto& [operation, codes] : alu) {
+            set(codes[0], operation, am::IMM);
+            set(codes[1], operation, am::ZPG);
+            set(codes[2], operation, am::ZPX);
+            set(codes[3], operation, am::ABS);
+            set(codes[4], operation, am::ABX);
+            set(codes[5], operation, am::ABY);
+        }
+
+        set(oc::CPX_IMM, op::CPX, am::IMM);
+        set(oc::CPX_ZPG, op::CPX, am::ZPG);
+        set(oc::CPX_ABS, op::CPX, am::ABS);
+        set(oc::CPY_IMM, op::CPY, am::IMM);
+        set(oc::CPY_ZPG, op::CPY, am::ZPG);
+        set(oc::CPY_ABS, op::CPY, am::ABS);
+        set(oc::BIT_ZPG, op::BIT, am::ZPG);
+        set(oc::BIT_ABS, op::BIT, am::ABS);
+
+        const std::array<std::pair<op, std::array<oc::opcode, 5>>, 4> shifts { {
+            { op::ASL, { oc::ASL_ACC, oc::ASL_ZPG, oc::ASL_ZPX, oc::ASL_ABS, oc::ASL_ABX } },
+            { op::LSR, { oc::LSR_ACC, oc::LSR_ZPG, oc::LSR_ZPX, oc::LSR_ABS, oc::LSR_ABX } },
+            { op::ROL, { oc::ROL_ACC, oc::ROL_ZPG, oc::ROL_ZPX, oc::ROL_ABS, oc::ROL_ABX } },
+            { op::ROR, { oc::ROR_ACC, oc::ROR_ZPG, oc::ROR_ZPX, oc::ROR_ABS, oc::ROR_ABX } },
+        } };
+        for (const auto& [operation, codes] : shifts) {
+            set(codes[0], operation, am::ACC);
+            set(codes[1], operation, am::ZPG);
+            set(codes[2], operation, am::ZPX);
+            set(codes[3], operation, am::ABS);
+            set(codes[4], operation, am::ABX);
+        }
+
+        set(oc::INC_ZPG, op::INC, am::ZPG);
+        set(oc::INC_ZPX, op::INC, am::ZPX);
+        set(oc::INC_ABS, op::INC, am::ABS);
+        set(oc::INC_ABX, op::INC, am::ABX);
+        set(oc::DEC_ZPG, op::DEC, am::ZPG);
+        set(oc::DEC_ZPX, op::DEC, am::ZPX);
+        set(oc::DEC_ABS, op::DEC, am::ABS);
+        set(oc::DEC_ABX, op::DEC, am::ABX);
+
+        set(oc::INX_IMP, op::INX, am::IMP);
+        set(oc::INY_IMP, op::INY, am::IMP);
+        set(oc::DEX_IMP, op::DEX, am::IMP);
+        set(oc::DEY_IMP, op::DEY, am::IMP);
+        set(oc::TAX_IMP, op::TAX, am::IMP);
+        set(oc::TAY_IMP, op::TAY, am::IMP);
+        set(oc::TXA_IMP, op::TXA, am::IMP);
+        set(oc::TYA_IMP, op::TYA, am::IMP);
+        set(oc::TSX_IMP, op::TSX, am::IMP);
+        set(oc::TXS_IMP, op::TXS, am::IMP);
+        set(oc::CLC_IMP, op::CLC, am::IMP);
+        set(oc::SEC_IMP, op::SEC, am::IMP);
+        set(oc::CLI_IMP, op::CLI, am::IMP);
+        set(oc::SEI_IMP, op::SEI, am::IMP);
+        set(oc::CLD_IMP, op::CLD, am::IMP);
+        set(oc::SED_IMP, op::SED, am::IMP);
+        set(oc::CLV_IMP, op::CLV, am::IMP);
+        set(oc::NOP_IMP, op::NOP, am::IMP);
+        set(oc::PHA_IMP, op::PHA, am::IMP);
+        set(oc::PLA_IMP, op::PLA, am::IMP);
+        set(oc::PHP_IMP, op::PHP, am::IMP);
+        set(oc::PLP_IMP, op::PLP, am::IMP);
+
+        set(oc::BPL____, op::BPL, am::REL);
+        set(oc::BMI____, op::BMI, am::REL);
+        set(oc::BVC____, op::BVC, am::REL);
+        set(oc::BVS____, op::BVS, am::REL);
+        set(oc::BCC____, op::BCC, am::REL);
+        set(oc::BCS____, op::BCS, am::REL);
+        set(oc::BNE____, op::BNE, am::REL);
+        set(oc::BEQ____, op::BEQ, am::REL);
+        set(oc::JMP_ABS, op::JMP, am::ABS);
+
+        return table;
+    }
+
+    constexpr std::array<translation_t, 256> translations = make_translations();
+
+    constexpr std::array<uint8_t, 256> make_nz_flags()
+    {
+        std::array<uint8_t, 256> table {};
+        for (size_t byte = 0; byte < table.size(); byte++)
+            table[byte] = (byte == 0 ? 0x02 : 0x00) | (byte & 0x80);
+        return table;
+    }
+
+    constexpr std::array<uint8_t, 256> nz_flags = make_nz_flags();
+
+    // status bits as laid out in cpu6502_base::status
+    constexpr uint8_t flag_C = 1 << 0;
+    constexpr uint8_t flag_Z = 1 << 1;
+    constexpr uint8_t flag_I = 1 << 2;
+    constexpr uint8_t flag_D = 1 << 3;
+    constexpr uint8_t flag_V = 1 << 6;
+    constexpr uint8_t flag_N = 1 << 7;
+
+    enum reg : uint8_t {
+        rax, rcx, rdx, rbx, rsp, rbp, rsi, rdi,
+        r8, r9, r10, r11, r12, r13, r14, r15
+    };
+
+    enum cond : uint8_t {
+        cc_o = 0x0,
+        cc_c = 0x2,
+        cc_nc = 0x3,
+        cc_z = 0x4,
+        cc_nz = 0x5,
+        cc_always = 0xFF
+    };
+
+    // group 1 opcode extensions
+    enum alu : uint8_t {
+        alu_add = 0,
+        alu_or = 1,
+        alu_and = 4,
+        alu_cmp = 7
+    };
+
+    // 6502 registers are pinned to callee-saved host registers for the whole call
+    constexpr reg reg_A = r12;
+    constexpr reg reg_X = r13;
+    constexpr reg reg_Y = r14;
+    constexpr reg reg_S = r15;
+    constexpr reg reg_P = rbp;
+    constexpr reg reg_ctx = rbx;
+    constexpr reg reg_nz = rsi;
+    constexpr reg reg_pages = r9;
+    constexpr reg reg_page = rdi; // RAM of the current operand's page
+    constexpr reg reg_extra = r10; // page crossing cycles, added to the static count on exit
+    constexpr reg reg_flags = r11;
+
+#ifdef _WIN32
+    constexpr reg reg_arg = rcx;
+#else
+    constexpr reg reg_arg = rdi;
+#endif
+
+    // spl, bpl, sil and dil are only reachable with a REX prefix
+    bool needs_rex(reg r)
+    {
+        return r >= rsp && r <= rdi;
+    }
+
+    class assembler {
+    public:
+        std::vector<uint8_t> code;
+
+        void byte(uint8_t value) { code.push_back(value); }
+        void word(uint16_t value)
+        {
+            byte(lo(value));
+            byte(value >> 8);
+        }
+        void dword(uint32_t value)
+        {
+            word(value & 0xFFFF);
+            word(value >> 16);
+        }
+
+        void rex(bool w, uint8_t r, uint8_t x, uint8_t b, bool force = false)
+        {
+            uint8_t value = 0x40 | (w << 3) | ((r & 8) >> 1) | ((x & 8) >> 2) | ((b & 8) >> 3);
+            if (value != 0x40 || force)
+                byte(value);
+        }
+
+        // op r/m, reg with both operands in registers
+        void rr(std::initializer_list<uint8_t> opcode, uint8_t r, uint8_t rm, bool w = false, bool byte_regs = false)
+        {
+            rex(w, r, 0, rm, byte_regs && (needs_rex(reg(r)) || needs_rex(reg(rm))));
+            for (uint8_t value : opcode)
+                byte(value);
+            byte(0xC0 | ((r & 7) << 3) | (rm & 7));
+        }
+
+        // op with [base + index * scale + disp32], immediates follow
+        void mem(std::initializer_list<uint8_t> opcode, uint8_t r, reg base, int32_t disp,
+            bool w = false, bool byte_reg = false, int index = -1, uint8_t scale = 0)
+        {
+            rex(w, r, index < 0 ? 0 : index, base, byte_reg && needs_rex(reg(r)));
+            for (uint8_t value : opcode)
+                byte(value);
+
+            if (index < 0 && (base & 7) != rsp) {
+                byte(0x80 | ((r & 7) << 3) | (base & 7));
+            } else {
+                byte(0x84 | ((r & 7) << 3));
+                byte((scale << 6) | ((index < 0 ? rsp : index) & 7) << 3 | (base & 7));
+            }
+            dword(disp);
+        }
+
+        void mov_imm(reg r, uint32_t value)
+        {
+            rex(false, 0, 0, r);
+            byte(0xB8 | (r & 7));
+            dword(value);
+        }
+
+        void mov(reg dst, reg src) { rr({ 0x89 }, src, dst); }
+        void movzx8(reg dst, reg src) { rr({ 0x0F, 0xB6 }, dst, src, false, true); }
+
+        void alu_imm(alu ext, reg r, uint32_t value)
+        {
+            rex(false, 0, 0, r);
+            byte(0x81);
+            byte(0xC0 | (ext << 3) | (r & 7));
+            dword(value);
+        }
+
+        void alu8_imm(alu ext, reg r, uint8_t value)
+        {
+            rex(false, 0, 0, r, needs_rex(r));
+            byte(0x80);
+            byte(0xC0 | (ext << 3) | (r & 7));
+            byte(value);
+        }
+
+        // group 2 shift by one, group 4 inc/dec, both on byte registers
+        void unary8(uint8_t opcode, uint8_t ext, reg r)
+        {
+            rex(false, 0, 0, r, needs_rex(r));
+            byte(opcode);
+            byte(0xC0 | (ext << 3) | (r & 7));
+        }
+
+        void setcc(cond cc, reg r)
+        {
+            rex(false, 0, 0, r, needs_rex(r));
+            byte(0x0F);
+            byte(0x90 | cc);
+            byte(0xC0 | (r & 7));
+        }
+
+        void test64(reg r) { rr({ 0x85 }, r, r, true); }
+
+        void test_imm(reg r, uint32_t value)
+        {
+            rex(false, 0, 0, r);
+            byte(0xF7);
+            byte(0xC0 | (r & 7));
+            dword(value);
+        }
+
+        void carry_from_P()
+        {
+            // bt ebp, 0
+            byte(0x0F);
+            byte(0xBA);
+            byte(0xE0 | reg_P);
+            byte(0);
+        }
+
+        void push(reg r)
+        {
+            rex(false, 0, 0, r);
+            byte(0x50 | (r & 7));
+        }
+
+        void pop(reg r)
+        {
+            rex(false, 0, 0, r);
+            byte(0x58 | (r & 7));
+        }
+
+        // emits a rel32 jump, returns the offset to patch
+        size_t jump(cond cc)
+        {
+            if (cc == cc_always) {
+                byte(0xE9);
+            } else {
+                byte(0x0F);
+                byte(0x80 | cc);
+            }
+            dword(0);
+            return code.size() - 4;
+        }
+
+        void patch(size_t offset, size_t target)
+        {
+            uint32_t rel = static_cast<uint32_t>(target - (offset + 4));
+            for (int i = 0; i < 4; i++)
+                code[offset + i] = (rel >> (i * 8)) & 0xFF;
+        }
+
+    private:
+        static uint8_t lo(uint16_t value) { return value & 0xFF; }
+    };
+
+    class translator {
+    public:
+        translator(const jit_x64::instruction* ops, size_t count, uint16_t stop)
+            : ops(ops)
+            , count(count)
+            , stop(stop)
+        {
+        }
+
+        // false when not even the first instruction translates
+        bool run();
+
+        std::vector<uint8_t>& code() { return as.code; }
+
+    private:
+        struct exit_t {
+            size_t patch;
+            uint16_t pc;
+            uint32_t cycles;
+            jit_x64::exit_kind kind;
+        };
+
+        // where the operand of the current instruction lives once prepared,
+        // reg_page holds the page pointer and either the low byte or r8 the offset
+        struct location_t {
+            bool dynamic; // effective address in edx
+            uint16_t address; // static effective address
+        };
+
+        assembler as;
+        std::vector<exit_t> exits;
+        const jit_x64::instruction* ops;
+        size_t count;
+        uint16_t stop;
+
+        jit_x64::instruction current {};
+        translation_t kind {};
+        location_t location {};
+        uint32_t before = 0; // static cycles before the current instruction
+        uint32_t after = 0; // and after it
+        uint16_t next_pc = 0;
+
+        void prologue();
+        void epilogue();
+
+        void exit(cond cc, uint16_t pc, uint32_t cycles, jit_x64::exit_kind exit_kind);
+        void fallback(cond cc) { exit(cc, current.pc, before, jit_x64::fallback); }
+
+        void address();
+        void page_pointer();
+        void readable();
+        void writable();
+        void access(std::initializer_list<uint8_t> opcode, reg r);
+        void load_operand();
+        void store_operand() { access({ 0x88 }, rcx); }
+        void page_cross();
+        void nz(reg r);
+        void carry_and(reg r, uint8_t cleared);
+
+        bool instruction();
+        bool check_stop();
+        void stack_stop(uint8_t final_offset);
+    };
+
+    void translator::prologue()
+    {
+        for (reg r : { rbx, rbp, rsi, rdi, r12, r13, r14, r15 })
+            as.push(r);
+
+        as.rr({ 0x89 }, reg_arg, reg_ctx, true);
+
+        as.mem({ 0x0F, 0xB6 }, reg_A, reg_ctx, offsetof(jit_x64::context, A));
+        as.mem({ 0x0F, 0xB6 }, reg_X, reg_ctx, offsetof(jit_x64::context, X));
+        as.mem({ 0x0F, 0xB6 }, reg_Y, reg_ctx, offsetof(jit_x64::context, Y));
+        as.mem({ 0x0F, 0xB6 }, reg_S, reg_ctx, offsetof(jit_x64::context, S));
+        as.mem({ 0x0F, 0xB6 }, reg_P, reg_ctx, offsetof(jit_x64::context, P));
+
+        as.mem({ 0x8B }, reg_pages, reg_ctx, offsetof(jit_x64::context, pages), true);
+        as.mem({ 0x8B }, reg_flags, reg_ctx, offsetof(jit_x64::context, page_flags), true);
+        as.mem({ 0x8B }, reg_nz, reg_ctx, offsetof(jit_x64::context, nz_flags), true);
+
+        as.rr({ 0x31 }, reg_extra, reg_extra);
+    }
+
+    void translator::epilogue()
+    {
+        const size_t label = as.code.size();
+
+        // rax holds the cycles
+        as.mem({ 0x89 }, rax, reg_ctx, offsetof(jit_x64::context, cycles), true);
+        as.mem({ 0x88 }, reg_A, reg_ctx, offsetof(jit_x64::context, A));
+        as.mem({ 0x88 }, reg_X, reg_ctx, offsetof(jit_x64::context, X));
+        as.mem({ 0x88 }, reg_Y, reg_ctx, offsetof(jit_x64::context, Y));
+        as.mem({ 0x88 }, reg_S, reg_ctx, offsetof(jit_x64::context, S));
+        as.mem({ 0x88 }, reg_P, reg_ctx, offsetof(jit_x64::context, P), false, true);
+
+        for (reg r : { r15, r14, r13, r12, rdi, rsi, rbp, rbx })
+            as.pop(r);
+        as.byte(0xC3);
+
+        // exit stubs live out of line, after the epilogue
+        for (const exit_t& exit : exits) {
+            as.patch(exit.patch, as.code.size());
+
+            as.byte(0x66);
+            as.mem({ 0xC7 }, 0, reg_ctx, offsetof(jit_x64::context, pc));
+            as.word(exit.pc);
+            as.mem({ 0xC6 }, 0, reg_ctx, offsetof(jit_x64::context, exit));
+            as.byte(exit.kind);
+            as.mov_imm(rax, exit.cycles);
+            as.rr({ 0x01 }, reg_extra, rax, true);
+            as.patch(as.jump(cc_always), label);
+        }
+    }
+
+    void translator::exit(cond cc, uint16_t pc, uint32_t cycles, jit_x64::exit_kind exit_kind)
+    {
+        exits.push_back({ as.jump(cc), pc, cycles, exit_kind });
+    }
+
+    void translator::address()
+    {
+        const uint16_t operand = current.operand;
+
+        switch (kind.mode) {
+        case addressing::ZPG:
+            location = { false, static_cast<uint16_t>(operand & 0xFF) };
+            return;
+
+        case addressing::ABS:
+            location = { false, operand };
+            return;
+
+        case addressing::ZPX:
+        case addressing::ZPY:
+            as.movzx8(rdx, kind.mode == addressing::ZPX ? reg_X : reg_Y);
+            as.alu_imm(alu_add, rdx, operand & 0xFF);
+            as.movzx8(rdx, rdx);
+            break;
+
+        case addressing::ABX:
+        case addressing::ABY:
+            as.movzx8(rdx, kind.mode == addressing::ABX ? reg_X : reg_Y);
+            as.alu_imm(alu_add, rdx, operand);
+            as.rr({ 0x0F, 0xB7 }, rdx, rdx); // movzx edx, dx
+            break;
+
+        default:
+            break;
+        }
+
+        location = { true, 0 };
+    }
+
+    void translator::page_pointer()
+    {
+        if (location.dynamic) {
+            as.code.insert(as.code.end(), { 0x0F, 0xB6, 0xC6 }); // movzx eax, dh
+            as.mem({ 0x8B }, reg_page, reg_pages, 0, true, false, rax, 3);
+        } else {
+            as.mem({ 0x8B }, reg_page, reg_pages, (location.address >> 8) * 8, true);
+        }
+
+        as.test64(reg_page);
+        fallback(cc_z);
+
+        if (location.dynamic)
+            as.movzx8(r8, rdx);
+    }
+
+    void translator::readable()
+    {
+        page_pointer();
+    }
+
+    void translator::writable()
+    {
+        // code, breakpoints and anything else flagged on the page needs the interpreter's write
+        if (location.dynamic) {
+            as.code.insert(as.code.end(), { 0x0F, 0xB6, 0xC6 }); // movzx eax, dh
+            as.mem({ 0x80 }, alu_cmp, reg_flags, 0, false, false, rax, 0);
+        } else {
+            as.mem({ 0x80 }, alu_cmp, reg_flags, location.address >> 8);
+        }
+        as.byte(0);
+        fallback(cc_nz);
+
+        page_pointer();
+    }
+
+    void translator::access(std::initializer_list<uint8_t> opcode, reg r)
+    {
+        if (location.dynamic)
+            as.mem(opcode, r, reg_page, 0, false, true, r8, 0);
+        else
+            as.mem(opcode, r, reg_page, location.address & 0xFF, false, true);
+    }
+
+    void translator::load_operand()
+    {
+        if (kind.mode == addressing::IMM) {
+            as.mov_imm(rcx, current.operand & 0xFF);
+            return;
+        }
+
+        address();
+        readable();
+        access({ 0x0F, 0xB6 }, rcx);
+    }
+
+    void translator::page_cross()
+    {
+        if (kind.mode != addressing::ABX && kind.mode != addressing::ABY)
+            return;
+
+        // cmp dh, imm8, the high byte moved when the index carried
+        as.code.insert(as.code.end(), { 0x80, 0xFE, static_cast<uint8_t>(current.operand >> 8) });
+        as.setcc(cc_nz, rax);
+        as.movzx8(rax, rax);
+        as.rr({ 0x01 }, rax, reg_extra);
+    }
+
+    void translator::nz(reg r)
+    {
+        as.alu_imm(alu_and, reg_P, ~static_cast<uint32_t>(flag_N | flag_Z));
+        as.movzx8(rax, r);
+        as.mem({ 0x0A }, reg_P, reg_nz, 0, false, true, rax, 0);
+    }
+
+    // P = P & ~cleared | r, r holding a carry of 0 or 1
+    void translator::carry_and(reg r, uint8_t cleared)
+    {
+        as.alu_imm(alu_and, reg_P, ~static_cast<uint32_t>(cleared));
+        as.rr({ 0x08 }, r, reg_P, false, true);
+    }
+
+    bool translator::check_stop()
+    {
+        switch (kind.mode) {
+        case addressing::IMP:
+        case addressing::ACC:
+        case addressing::IMM:
+            if (static_cast<uint16_t>(current.pc + 1) != stop)
+                return false;
+            break;
+
+        case addressing::ZPG:
+        case addressing::ABS:
+            if (location.address != stop)
+                return false;
+            break;
+
+        case addressing::ZPX:
+        case addressing::ZPY:
+        case addressing::ABX:
+        case addressing::ABY:
+            if ((kind.mode == addressing::ZPX || kind.mode == addressing::ZPY) && stop > 0xFF)
+                return false;
+            as.alu_imm(alu_cmp, rdx, stop);
+            exit(cc_z, next_pc, after, jit_x64::stopped);
+            return false;
+
+        default:
+            return false;
+        }
+
+        exit(cc_always, next_pc, after, jit_x64::stopped);
+        return true;
+    }
+
+    void translator::stack_stop(uint8_t final_offset)
+    {
+        if ((stop >> 8) != 0x01)
+            return;
+
+        as.alu8_imm(alu_cmp, reg_S, final_offset);
+        exit(cc_z, next_pc, after, jit_x64::stopped);
+    }
+
+    // returns true once the instruction left the translated code for good
+    bool translator::instruction()
+    {
+        switch (kind.op) {
+        case operation::LDA:
+        case operation::LDX:
+        case operation::LDY: {
+            const reg dst = kind.op == operation::LDA ? reg_A : kind.op == operation::LDX ? reg_X : reg_Y;
+            load_operand();
+            page_cross();
+            as.mov(dst, rcx);
+            nz(dst);
+            break;
+        }
+
+        case operation::STA:
+        case operation::STX:
+        case operation::STY: {
+            const reg src = kind.op == operation::STA ? reg_A : kind.op == operation::STX ? reg_X : reg_Y;
+            address();
+            writable();
+            as.mov(rcx, src);
+            store_operand();
+            break;
+        }
+
+        case operation::ORA:
+        case operation::AND:
+        case operation::EOR: {
+            const uint8_t opcode = kind.op == operation::ORA ? 0x08 : kind.op == operation::AND ? 0x20 : 0x30;
+            load_operand();
+            page_cross();
+            as.rr({ opcode }, rcx, reg_A, false, true);
+            nz(reg_A);
+            break;
+        }
+
+        case operation::ADC:
+        case operation::SBC:
+            load_operand();
+            page_cross();
+            as.carry_from_P();
+            if (kind.op == operation::ADC) {
+                as.rr({ 0x10 }, rcx, reg_A, false, true); // adc
+                as.setcc(cc_c, rax);
+            } else {
+                // sbb borrows the inverted carry, A + ~M + C == A - M - !C
+                as.byte(0xF5); // cmc
+                as.rr({ 0x18 }, rcx, reg_A, false, true); // sbb
+                as.setcc(cc_nc, rax);
+            }
+            as.setcc(cc_o, r8);
+            carry_and(rax, flag_C | flag_V);
+            as.unary8(0xC0, 4, r8); // shl r8b, 6
+            as.byte(6);
+            as.rr({ 0x08 }, r8, reg_P, false, true);
+            nz(reg_A);
+            break;
+
+        case operation::CMP:
+        case operation::CPX:
+        case operation::CPY: {
+            const reg src = kind.op == operation::CMP ? reg_A : kind.op == operation::CPX ? reg_X : reg_Y;
+            load_operand();
+            page_cross();
+            as.mov(rax, src);
+            as.rr({ 0x28 }, rcx, rax, false, true); // sub al, cl
+            as.setcc(cc_nc, r8);
+            carry_and(r8, flag_C);
+            nz(rax);
+            break;
+        }
+
+        case operation::BIT:
+            load_operand();
+            as.alu_imm(alu_and, reg_P, ~static_cast<uint32_t>(flag_N | flag_V | flag_Z));
+            as.mov(rax, rcx);
+            as.alu_imm(alu_and, rax, flag_N | flag_V);
+            as.rr({ 0x09 }, rax, reg_P);
+            as.rr({ 0x84 }, rcx, reg_A, false, true); // test r12b, cl
+            as.setcc(cc_z, rax);
+            as.rr({ 0x00 }, rax, rax, false, true); // add al, al
+            as.rr({ 0x08 }, rax, reg_P, false, true);
+            break;
+
+        case operation::ASL:
+        case operation::LSR:
+        case operation::ROL:
+        case operation::ROR: {
+            reg target = reg_A;
+            if (kind.mode != addressing::ACC) {
+                address();
+                writable();
+                access({ 0x0F, 0xB6 }, rcx);
+                target = rcx;
+            }
+
+            const uint8_t ext = kind.op == operation::ASL ? 4 : kind.op == operation::LSR ? 5 : kind.op == operation::ROL ? 2 : 3;
+            if (kind.op == operation::ROL || kind.op == operation::ROR)
+                as.carry_from_P();
+            as.unary8(0xD0, ext, target);
+            as.setcc(cc_c, rax);
+            carry_and(rax, flag_C);
+            nz(target);
+
+            if (kind.mode != addressing::ACC)
+                store_operand();
+            break;
+        }
+
+        case operation::INC:
+        case operation::DEC:
+            address();
+            writable();
+            access({ 0x0F, 0xB6 }, rcx);
+            as.unary8(0xFE, kind.op == operation::INC ? 0 : 1, rcx);
+            nz(rcx);
+            store_operand();
+            break;
+
+        case operation::INX:
+        case operation::INY:
+        case operation::DEX:
+        case operation::DEY: {
+            const reg r = kind.op == operation::INX || kind.op == operation::DEX ? reg_X : reg_Y;
+            as.unary8(0xFE, kind.op == operation::INX || kind.op == operation::INY ? 0 : 1, r);
+            nz(r);
+            break;
+        }
+
+        case operation::TAX:
+            as.mov(reg_X, reg_A);
+            nz(reg_X);
+            break;
+
+        case operation::TAY:
+            as.mov(reg_Y, reg_A);
+            nz(reg_Y);
+            break;
+
+        case operation::TXA:
+            as.mov(reg_A, reg_X);
+            nz(reg_A);
+            break;
+
+        case operation::TYA:
+            as.mov(reg_A, reg_Y);
+            nz(reg_A);
+            break;
+
+        case operation::TSX:
+            as.mov(reg_X, reg_S);
+            nz(reg_X);
+            break;
+
+        case operation::TXS:
+            as.mov(reg_S, reg_X);
+            break;
+
+        case operation::CLC:
+            as.alu_imm(alu_and, reg_P, ~static_cast<uint32_t>(flag_C));
+            break;
+
+        case operation::SEC:
+            as.alu_imm(alu_or, reg_P, flag_C);
+            break;
+
+        case operation::CLI:
+            as.alu_imm(alu_and, reg_P, ~static_cast<uint32_t>(flag_I));
+            break;
+
+        case operation::SEI:
+            as.alu_imm(alu_or, reg_P, flag_I);
+            break;
+
+        case operation::CLD:
+            as.alu_imm(alu_and, reg_P, ~static_cast<uint32_t>(flag_D));
+            break;
+
+        case operation::SED:
+            as.alu_imm(alu_or, reg_P, flag_D);
+            break;
+
+        case operation::CLV:
+            as.alu_imm(alu_and, reg_P, ~static_cast<uint32_t>(flag_V));
+            break;
+
+        case operation::NOP:
+            break;
+
+        case operation::PHA:
+        case operation::PHP:
+            location = { false, 0x0100 };
+            writable();
+            as.mov(rcx, kind.op == operation::PHA ? reg_A : reg_P);
+            as.movzx8(r8, reg_S);
+            as.mem({ 0x88 }, rcx, reg_page, 0, false, true, r8, 0);
+            as.unary8(0xFE, 1, reg_S);
+            stack_stop((stop - 1) & 0xFF);
+            return false;
+
+        case operation::PLA:
+        case operation::PLP:
+            location = { false, 0x0100 };
+            readable();
+            as.unary8(0xFE, 0, reg_S);
+            as.movzx8(r8, reg_S);
+            as.mem({ 0x0F, 0xB6 }, rcx, reg_page, 0, false, false, r8, 0);
+            if (kind.op == operation::PLA) {
+                as.mov(reg_A, rcx);
+                nz(reg_A);
+            } else {
+                // B and the unused bit always read back as set
+                as.alu_imm(alu_or, rcx, 0x30);
+                as.mov(reg_P, rcx);
+            }
+            stack_stop(stop & 0xFF);
+            return false;
+
+        case operation::BPL:
+        case operation::BMI:
+        case operation::BVC:
+        case operation::BVS:
+        case operation::BCC:
+        case operation::BCS:
+        case operation::BNE:
+        case operation::BEQ: {
+            uint8_t mask = 0;
+            bool if_set = false;
+            switch (kind.op) {
+            case operation::BPL: mask = flag_N; break;
+            case operation::BMI: mask = flag_N; if_set = true; break;
+            case operation::BVC: mask = flag_V; break;
+            case operation::BVS: mask = flag_V; if_set = true; break;
+            case operation::BCC: mask = flag_C; break;
+            case operation::BCS: mask = flag_C; if_set = true; break;
+            case operation::BNE: mask = flag_Z; break;
+            default: mask = flag_Z; if_set = true; break;
+            }
+
+            const uint16_t target = next_pc + static_cast<int8_t>(current.operand & 0xFF);
+            const uint32_t taken = after + 1 + ((target >> 8) != (next_pc >> 8));
+            const uint16_t offset_address = current.pc + 1;
+
+            as.test_imm(reg_P, mask);
+            exit(if_set ? cc_nz : cc_z, target, taken, target == stop ? jit_x64::stopped : jit_x64::next_block);
+            exit(cc_always, next_pc, after, offset_address == stop ? jit_x64::stopped : jit_x64::next_block);
+            return true;
+        }
+
+        case operation::JMP:
+            exit(cc_always, current.operand, after, current.operand == stop ? jit_x64::stopped : jit_x64::next_block);
+            return true;
+
+        default:
+            break;
+        }
+
+        return check_stop();
+    }
+
+    bool translator::run()
+    {
+        prologue();
+
+        bool closed = false;
+        for (size_t i = 0; i < count && !closed; i++) {
+            current = ops[i];
+            kind = translations[current.oc];
+            next_pc = current.pc + current.length;
+
+            if (kind.op == operation::none) {
+                if (i == 0)
+                    return false;
+                exit(cc_always, current.pc, before, jit_x64::fallback);
+                closed = true;
+                break;
+            }
+
+            after = before + current.cycles;
+            closed = instruction();
+            before = after;
+        }
+
+        if (!closed)
+            exit(cc_always, next_pc, before, jit_x64::next_block);
+
+        epilogue();
+        return true;
+    }
+
+}
+
+jit_x64::jit_x64(size_t capacity)
+{
+    ctx.pages = pages.data();
+    ctx.nz_flags = nz_flags.data();
+
+    if (!is_supported())
+        return;
+
+#ifdef _WIN32
+    void* memory = VirtualAlloc(nullptr, capacity, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#else
+    void* memory = mmap(nullptr, capacity, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        memory = nullptr;
+#endif
+
+    if (memory) {
+        buffer = static_cast<uint8_t*>(memory);
+        this->capacity = capacity;
+    }
+}
+
+jit_x64::~jit_x64()
+{
+    if (!buffer)
+        return;
+
+#ifdef _WIN32
+    VirtualFree(buffer, 0, MEM_RELEASE);
+#else
+    munmap(buffer, capacity);
+#endif
+}
+
+bool jit_x64::is_supported()
+{
+#ifdef JIT_X64_HOST
+    return true;
+#else
+    return false;
+#endif
+}
+
+jit_x64::entry_t jit_x64::translate(const instruction* ops, size_t count, uint16_t stop)
+{
+    if (!buffer || full || count == 0)
+        return nullptr;
+
+    translator translation(ops, count, stop);
+    if (!translation.run())
+        return nullptr;
+
+    const std::vector<uint8_t>& code = translation.code();
+    if (used + code.size() > capacity) {
+        full = true;
+        return nullptr;
+    }
+
+    uint8_t* entry = buffer + used;
+    std::copy(code.begin(), code.end(), entry);
+    used += code.size();
+    return reinterpret_cast<entry_t>(entry);
+}
+
+void jit_x64::flush()
+{
+    used = 0;
+    full = false;
+}
+
+}
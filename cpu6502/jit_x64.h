@@ -0,0 +1,66 @@
+#pragma once
+
+#include "types.h"
+
+namespace emulator {
+
+// translates straight-line 6502 code into x86-64 code for basic_cpu6502's jit tier,
+// on other hosts translate always returns null and the cpu keeps interpreting
+class jit_x64 {
+public:
+    enum exit_kind : uint8_t {
+        next_block, // pc is the successor, nothing left to do
+        fallback, // the interpreter has to execute the instruction at pc
+        stopped // the instruction before pc ended on the stop address
+    };
+
+    // shared with the generated code, A/X/Y/S/P live in host registers in between
+    struct context {
+        uint8_t* const* pages; // RAM per page, null sends the access back to the interpreter
+        const uint8_t* page_flags; // nonzero sends stores to the page back to the interpreter
+        const uint8_t* nz_flags; // N and Z bits per result byte
+        uint64_t cycles; // spent by the last call
+        uint16_t pc;
+        uint8_t A;
+        uint8_t X;
+        uint8_t Y;
+        uint8_t S;
+        uint8_t P;
+        exit_kind exit;
+    };
+
+    struct instruction {
+        uint16_t pc;
+        uint16_t operand;
+        uint8_t oc;
+        uint8_t cycles;
+        uint8_t length;
+    };
+
+    using entry_t = void (*)(context*);
+
+    explicit jit_x64(size_t capacity = 1024 * 1024);
+    ~jit_x64();
+
+    jit_x64(const jit_x64&) = delete;
+    jit_x64& operator=(const jit_x64&) = delete;
+
+    static bool is_supported();
+
+    // translates the longest supported prefix of count instructions, exits where the bus address
+    // of an instruction equals stop, null when the first instruction isn't supported or the buffer is full
+    entry_t translate(const instruction* ops, size_t count, uint16_t stop);
+    bool is_full() const { return full; }
+    void flush();
+
+    std::array<uint8_t*, 256> pages {};
+    context ctx {};
+
+private:
+    uint8_t* buffer = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;
+    bool full = false;
+};
+
+}
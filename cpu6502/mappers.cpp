@@ -0,0 +1,58 @@
+#include "mappers.h"
+
+namespace emulator {
+
+static constexpr size_t pages_in(size_t bytes)
+{
+    return bytes >> 8;
+}
+
+uxrom_mapper::uxrom_mapper(paged_bus& bus, std::vector<uint8_t> rom)
+    : bus(bus)
+    , rom(std::move(rom))
+    , bank_count(this->rom.size() / bank_size)
+{
+    if (bank_count < 2 || this->rom.size() % bank_size)
+        throw std::invalid_argument("UxROM image must be a multiple of 16KB with two banks at least");
+
+    bus.map_rom(0xC0, pages_in(bank_size), this->rom.data() + (bank_count - 1) * bank_size, this);
+    bus.map_rom(0x80, pages_in(bank_size), this->rom.data(), this);
+}
+
+uint8_t uxrom_mapper::read(uint16_t address)
+{
+    const size_t offset = address & (bank_size - 1);
+    return address >= 0xC000
+        ? rom[(bank_count - 1) * bank_size + offset]
+        : rom[bank * bank_size + offset];
+}
+
+void uxrom_mapper::select(size_t bank)
+{
+    this->bank = bank % bank_count;
+    switches++;
+    bus.map_rom(0x80, pages_in(bank_size), rom.data() + this->bank * bank_size, this);
+}
+
+banked_ram_mapper::banked_ram_mapper(paged_bus& bus, size_t banks, uint8_t register_page)
+    : bus(bus)
+    , ram(banks * bank_size)
+    , bank_count(banks)
+{
+    if (bank_count == 0)
+        throw std::invalid_argument("banked RAM needs a bank");
+    if (register_page >= window && register_page < window + pages_in(bank_size))
+        throw std::invalid_argument("bank register page inside the window");
+
+    bus.map_device(register_page, 1, *this);
+    bus.map_ram(window, pages_in(bank_size), ram.data());
+}
+
+void banked_ram_mapper::select(size_t bank)
+{
+    this->bank = bank % bank_count;
+    switches++;
+    bus.map_ram(window, pages_in(bank_size), ram.data() + this->bank * bank_size);
+}
+
+}
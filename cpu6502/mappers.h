@@ -0,0 +1,59 @@
+#pragma once
+
+#include "types.h"
+#include "i_device.h"
+#include "paged_bus.h"
+
+namespace emulator {
+
+// reference mappers for images larger than 64KB, a bank switch rewrites paged_bus page entries
+// and never copies memory, both keep the whole image and must outlive the bus mapping
+
+// UxROM style: 16KB ROM banks, the selected one at $8000-$BFFF, the last one fixed at $C000-$FFFF,
+// any write to $8000-$FFFF selects the bank
+class uxrom_mapper final : public i_device {
+public:
+    uxrom_mapper(paged_bus& bus, std::vector<uint8_t> rom); // a multiple of 16KB, two banks at least
+
+    uint8_t read(uint16_t address) override; // ROM pages are read through the page table
+    void write(uint16_t, uint8_t byte) override { select(byte); }
+
+    void select(size_t bank); // modulo the bank count
+    size_t get_bank() const { return bank; }
+    size_t get_switches() const { return switches; }
+
+    static constexpr size_t bank_size = 16 * 1024;
+
+private:
+    paged_bus& bus;
+    std::vector<uint8_t> rom;
+    size_t bank_count {};
+    size_t bank {};
+    size_t switches {};
+};
+
+// RAM beyond the address space seen through an 8KB window at $A000-$BFFF,
+// a write to the register page selects the bank, a read returns it
+class banked_ram_mapper final : public i_device {
+public:
+    banked_ram_mapper(paged_bus& bus, size_t banks, uint8_t register_page = 0xDF); // the register page outside the window
+
+    uint8_t read(uint16_t) override { return static_cast<uint8_t>(bank); }
+    void write(uint16_t, uint8_t byte) override { select(byte); }
+
+    void select(size_t bank); // modulo the bank count
+    size_t get_bank() const { return bank; }
+    size_t get_switches() const { return switches; }
+
+    static constexpr size_t bank_size = 8 * 1024;
+    static constexpr uint8_t window = 0xA0;
+
+private:
+    paged_bus& bus;
+    std::vector<uint8_t> ram;
+    size_t bank_count {};
+    size_t bank {};
+    size_t switches {};
+};
+
+}
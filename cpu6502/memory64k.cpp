@@ -5,16 +5,7 @@ namespace emulator {
 void memory64k::reset()
 {
     std::fill(memory.begin(), memory.end(), 0x00_u8);
-}
-
-uint8_t memory64k::read(uint16_t address)
-{
-    return memory.at(address);
-}
-
-void memory64k::write(uint16_t address, uint8_t byte)
-{
-    memory.at(address) = byte;
+    mark_all_dirty();
 }
 
 void memory64k::load_file(std::string filepath)
@@ -28,6 +19,83 @@ void memory64k::load_file(std::string filepath)
         file.read(reinterpret_cast<char*>(&memory[0]), size);
         file.close();
     }
+    mark_all_dirty();
+}
+
+void memory64k::restore(const memory_image& image)
+{
+    memory = image;
+    mark_all_dirty();
+}
+
+void memory64k::track_dirty_pages(bool enabled)
+{
+    tracking = enabled;
+    mark_clean();
+}
+
+void memory64k::mark_clean()
+{
+    dirty.fill(0);
+    marks++;
+}
+
+void memory64k::mark_all_dirty()
+{
+    if (tracking)
+        dirty.fill(~0ull);
+}
+
+void memory64k::set_baseline()
+{
+    if (!baseline)
+        baseline = std::make_unique<memory_image>();
+    *baseline = memory;
+    tracking = true;
+    mark_clean();
+}
+
+void memory64k::reset_to_baseline()
+{
+    if (!baseline)
+        throw std::logic_error("no baseline set");
+
+    for (size_t word = 0; word < dirty.size(); word++) {
+        for (uint64_t bits = dirty[word]; bits; bits &= bits - 1) {
+            const size_t offset = (word * 64 + std::countr_zero(bits)) << 8;
+            std::copy_n(baseline->begin() + offset, 256, memory.begin() + offset);
+        }
+    }
+    mark_clean();
+}
+
+void memory64k::snapshot_dirty(page_snapshot& snapshot) const
+{
+    snapshot.pages = dirty;
+    snapshot.bytes.clear();
+    for (size_t word = 0; word < dirty.size(); word++) {
+        for (uint64_t bits = dirty[word]; bits; bits &= bits - 1) {
+            const size_t offset = (word * 64 + std::countr_zero(bits)) << 8;
+            snapshot.bytes.insert(snapshot.bytes.end(), memory.begin() + offset, memory.begin() + offset + 256);
+        }
+    }
 }
 
-}
\ No newline at end of file
+void memory64k::restore(const page_snapshot& snapshot)
+{
+    reset_to_baseline();
+
+    // the restored pages differ from the baseline, so they stay dirty
+    auto bytes = snapshot.bytes.begin();
+    for (size_t word = 0; word < snapshot.pages.size(); word++) {
+        for (uint64_t bits = snapshot.pages[word]; bits; bits &= bits - 1) {
+            const size_t offset = (word * 64 + std::countr_zero(bits)) << 8;
+            std::copy_n(bytes, 256, memory.begin() + offset);
+            bytes += 256;
+        }
+    }
+    if (tracking)
+        dirty = snapshot.pages;
+}
+
+}
@@ -5,17 +5,60 @@
 
 namespace emulator {
 
-class memory64k : public i_bus {
+class memory64k final : public i_bus {
 public:
+    using page_set = std::array<uint64_t, 4>; // one bit per page
+
+    // the pages written since the last mark, in page order, 256 bytes each
+    struct page_snapshot {
+        page_set pages {};
+        std::vector<uint8_t> bytes;
+    };
+
     void reset() override;
-    uint8_t read(uint16_t address) override;
-    void write(uint16_t address, uint8_t byte) override;
+    // every uint16_t address is in range, no bounds check needed
+    uint8_t read(uint16_t address) override { return memory[address]; }
+    void write(uint16_t address, uint8_t byte) override
+    {
+        memory[address] = byte;
+        if (tracking)
+            dirty[address >> 14] |= 1ull << ((address >> 8) & 63);
+    }
     void load_file(std::string filepath) override;
+    uint8_t* ram_page(uint8_t page) { return memory.data() + (page << 8); }
+    const uint8_t* read_page(uint8_t page) const { return memory.data() + (page << 8); }
+
+    // bulk copies of the whole memory for savestates
+    void snapshot(memory_image& image) const { image = memory; }
+    void restore(const memory_image& image);
+
+    // opt-in, write marks the page it hits dirty, anything writing the whole memory marks every page,
+    // see dirty_tracking for how the jit's direct stores are caught
+    void track_dirty_pages(bool enabled);
+    bool is_tracking() const { return tracking; }
+    bool is_dirty(uint8_t page) const { return dirty[page >> 6] & (1ull << (page & 63)); }
+    const page_set& get_dirty_pages() const { return dirty; }
+    uint32_t get_marks() const { return marks; } // counts mark_clean calls, pages can only turn clean there
+    void mark_clean();
+
+    // keeps a copy of the memory to go back to and turns tracking on, reset_to_baseline copies back only the dirty pages
+    void set_baseline();
+    void reset_to_baseline();
+
+    // incremental snapshots against the baseline, restoring one goes back to the baseline first
+    void snapshot_dirty(page_snapshot& snapshot) const;
+    void restore(const page_snapshot& snapshot);
 
     ~memory64k() override = default;
 
 private:
-    std::array<uint8_t, 64 * 1024> memory = {};
+    void mark_all_dirty();
+
+    memory_image memory = {};
+    std::unique_ptr<memory_image> baseline;
+    page_set dirty {};
+    uint32_t marks {};
+    bool tracking = false;
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,86 @@
+#include "paged_bus.h"
+
+namespace emulator {
+
+paged_bus::paged_bus()
+{
+    map_ram(0x00, pages.size());
+}
+
+void paged_bus::reset()
+{
+    for (const page_t& page : pages) {
+        if (page.write)
+            std::fill_n(page.write, 0x100, 0x00_u8);
+    }
+}
+
+void paged_bus::load_file(std::string filepath)
+{
+    std::streampos size;
+    std::ifstream file(filepath, std::ifstream::binary);
+    if (file.is_open()) {
+        file.seekg(0, std::ios::end);
+        size = file.tellg();
+        file.seekg(0, std::ios::beg);
+        file.read(reinterpret_cast<char*>(&memory[0]), std::min<std::streamoff>(size, memory.size()));
+        file.close();
+    }
+}
+
+void paged_bus::load(uint16_t address, const std::vector<uint8_t>& bytes)
+{
+    const size_t count = std::min(bytes.size(), memory.size() - address);
+    std::copy_n(bytes.begin(), count, memory.begin() + address);
+}
+
+void paged_bus::map_ram(uint8_t first, size_t count)
+{
+    map_ram(first, count, memory.data() + (first << 8));
+}
+
+void paged_bus::map_rom(uint8_t first, size_t count)
+{
+    map_rom(first, count, memory.data() + (first << 8));
+}
+
+void paged_bus::map_ram(uint8_t first, size_t count, uint8_t* bank)
+{
+    check_range(first, count);
+    for (size_t i = 0; i < count; i++)
+        pages[first + i] = { bank + (i << 8), bank + (i << 8), nullptr };
+    remapped(first, count);
+}
+
+void paged_bus::map_rom(uint8_t first, size_t count, const uint8_t* bank, i_device* device)
+{
+    check_range(first, count);
+    for (size_t i = 0; i < count; i++)
+        pages[first + i] = { bank + (i << 8), nullptr, device };
+    remapped(first, count);
+}
+
+void paged_bus::map_device(uint8_t first, size_t count, i_device& device)
+{
+    check_range(first, count);
+    if (first < 0x02)
+        throw std::invalid_argument("zero page and stack page are always memory");
+
+    for (size_t page = first; page < first + count; page++)
+        pages[page] = { nullptr, nullptr, &device };
+    remapped(first, count);
+}
+
+void paged_bus::check_range(uint8_t first, size_t count) const
+{
+    if (first + count > pages.size())
+        throw std::out_of_range("mapping past the end of the address space");
+}
+
+void paged_bus::remapped(uint8_t first, size_t count)
+{
+    if (on_remap)
+        on_remap(first, count);
+}
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "types.h"
+#include "i_bus.h"
+#include "i_device.h"
+
+namespace emulator {
+
+// 64KB split into 256 byte pages, each page is RAM, ROM or a device,
+// RAM and ROM resolve to a host pointer so read and write never leave the header,
+// only device pages call out, starts as all RAM
+class paged_bus final : public i_bus {
+public:
+    paged_bus();
+
+    void reset() override; // clears the RAM mapped in, keeps ROM contents and the mapping
+    uint8_t read(uint16_t address) override
+    {
+        const page_t& page = pages[address >> 8];
+        if (page.read) [[likely]]
+            return page.read[address & 0xFF];
+        return page.device->read(address);
+    }
+    void write(uint16_t address, uint8_t byte) override
+    {
+        const page_t& page = pages[address >> 8];
+        if (page.write) [[likely]]
+            page.write[address & 0xFF] = byte;
+        else if (page.device)
+            page.device->write(address, byte);
+    }
+    void load_file(std::string filepath) override; // at address 0, ROM pages included
+    void load(uint16_t address, const std::vector<uint8_t>& bytes); // ROM pages included
+
+    // null for ROM and device pages, see ram_bus
+    uint8_t* ram_page(uint8_t page) { return pages[page].write; }
+    // null for device pages, see readable_pages
+    const uint8_t* read_page(uint8_t page) const { return pages[page].read; }
+
+    // count pages from first, zero page and the stack page can't hold a device,
+    // so zero page and stack accesses, like code fetched from RAM or ROM, always take the pointer path
+    void map_ram(uint8_t first, size_t count = 1);
+    void map_rom(uint8_t first, size_t count = 1); // writes are ignored
+    void map_device(uint8_t first, size_t count, i_device& device);
+
+    // banks, count * 256 bytes of outside memory the caller keeps alive, mapping only rewrites page entries,
+    // writes to ROM banks go to device if there is one, e.g. a mapper watching for its bank register
+    void map_ram(uint8_t first, size_t count, uint8_t* bank);
+    void map_rom(uint8_t first, size_t count, const uint8_t* bank, i_device* device = nullptr);
+
+    bool is_device(uint8_t page) const { return pages[page].device != nullptr; }
+
+    // bulk copies of the bus's own memory for savestates, outside banks and devices keep their state themselves
+    // and the mapping isn't part of it
+    void snapshot(memory_image& image) const { image = memory; }
+    void restore(const memory_image& image) { memory = image; }
+
+    // called after every mapping change, see remap_hook
+    std::function<void(uint8_t first, size_t count)> on_remap;
+
+    ~paged_bus() override = default;
+
+private:
+    struct page_t {
+        const uint8_t* read;
+        uint8_t* write;
+        i_device* device;
+    };
+
+    void check_range(uint8_t first, size_t count) const;
+    void remapped(uint8_t first, size_t count);
+
+    std::array<page_t, 256> pages {};
+    memory_image memory = {};
+};
+
+}
@@ -0,0 +1,85 @@
+#include "realtime_clock.h"
+
+namespace emulator {
+
+// falling further behind than this (debugger pause, host stall) rebases instead of catching up
+static constexpr auto max_lag = std::chrono::milliseconds(100);
+
+// the OS can't be trusted to wake us up more precisely than this, spin for the rest
+static constexpr auto spin_threshold = std::chrono::milliseconds(2);
+
+realtime_clock::realtime_clock()
+{
+    rebase();
+}
+
+void realtime_clock::reset()
+{
+    cycles = 0;
+    rebase();
+}
+
+void realtime_clock::set_cycles(size_t count)
+{
+    cycles = count;
+    rebase();
+}
+
+void realtime_clock::set_timing(size_t t)
+{
+    sync_interval = t;
+    rebase();
+}
+
+void realtime_clock::set_frequency(double hz)
+{
+    frequency = hz;
+    rebase();
+}
+
+void realtime_clock::set_warp(bool enabled)
+{
+    warp = enabled;
+    rebase();
+}
+
+void realtime_clock::rebase()
+{
+    if (warp) {
+        next_sync = std::numeric_limits<size_t>::max();
+        return;
+    }
+
+    cycles_per_sync = std::max<size_t>(1, static_cast<size_t>(frequency * sync_interval / 1'000'000.0));
+    base_time = std::chrono::steady_clock::now();
+    base_cycles = cycles;
+    next_sync = cycles + cycles_per_sync;
+}
+
+void realtime_clock::sync()
+{
+    // deadlines are measured from the base point, so rounding errors of single batches don't accumulate
+    auto elapsed = std::chrono::duration<double>((cycles - base_cycles) / frequency);
+    auto deadline = base_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(elapsed);
+    auto now = std::chrono::steady_clock::now();
+
+    if (now - deadline > max_lag) {
+        rebase();
+        return;
+    }
+
+    wait_until(deadline);
+    next_sync = cycles + cycles_per_sync;
+}
+
+void realtime_clock::wait_until(time_point deadline)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (deadline - now > spin_threshold)
+        std::this_thread::sleep_for(deadline - now - spin_threshold);
+
+    while (std::chrono::steady_clock::now() < deadline) {
+    }
+}
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "types.h"
+#include "i_clock.h"
+
+namespace emulator {
+
+// paces emulated cycles against wall time, syncing once per batch of cycles
+class realtime_clock final : public i_clock {
+public:
+    realtime_clock(); // pacing starts from now
+    void reset() override;
+    void cycle() override
+    {
+        cycles++;
+        if (cycles >= next_sync)
+            sync();
+    }
+    void add_cycles(size_t count) override
+    {
+        cycles += count;
+        if (cycles >= next_sync)
+            sync();
+    }
+    size_t get_cycles() override { return cycles; }
+    void set_cycles(size_t count) override; // pacing starts over from there
+    void set_timing(size_t) override; // sync interval in microseconds
+
+    void set_frequency(double hz);
+    void set_warp(bool enabled); // run unthrottled, never touching the OS
+
+    ~realtime_clock() override = default;
+
+private:
+    using time_point = std::chrono::steady_clock::time_point;
+
+    void rebase();
+    void sync();
+    void wait_until(time_point deadline);
+
+    size_t cycles {};
+    size_t next_sync {};
+    size_t cycles_per_sync {};
+
+    double frequency = 1'022'727.0; // Hz
+    size_t sync_interval = 1'000; // us
+    bool warp = false;
+
+    time_point base_time {}; // wall time matching base_cycles
+    size_t base_cycles {};
+};
+
+}
@@ -0,0 +1,226 @@
+#include "replay.h"
+
+namespace emulator {
+
+namespace {
+
+// the entry header is the cycle delta shifted past these bits
+constexpr size_t kind_bits = 2;
+
+void put(std::vector<uint8_t>& log, uint64_t value)
+{
+    for (; value >= 0x80; value >>= 7)
+        log.push_back(static_cast<uint8_t>(value | 0x80));
+    log.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t get(const std::vector<uint8_t>& log, size_t& position)
+{
+    uint64_t value = 0;
+    for (size_t shift = 0;; shift += 7) {
+        if (position == log.size())
+            throw std::runtime_error("replay log cut short");
+        const uint8_t byte = log[position++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+}
+
+}
+
+class input_recorder::tap_device final : public i_device {
+public:
+    tap_device(input_recorder& recorder, i_device& device)
+        : recorder(recorder)
+        , device(device)
+    {
+    }
+
+    uint8_t read(uint16_t address) override
+    {
+        recorder.begin_access();
+        recorder.in_access = true;
+        const uint8_t byte = device.read(address);
+        recorder.in_access = false;
+        recorder.log_read(byte);
+        return byte;
+    }
+
+    void write(uint16_t address, uint8_t byte) override
+    {
+        recorder.begin_access();
+        recorder.in_access = true;
+        device.write(address, byte);
+        recorder.in_access = false;
+    }
+
+private:
+    input_recorder& recorder;
+    i_device& device;
+};
+
+input_recorder::input_recorder(interrupt_lines& lines, cycle_source cycles)
+    : lines(lines)
+    , cycles(std::move(cycles))
+    , last_cycle(this->cycles())
+    , irq_sources(lines.get_irq_sources())
+    , nmi_level(lines.nmi())
+{
+    lines.watcher = this;
+}
+
+input_recorder::~input_recorder()
+{
+    if (lines.watcher == this)
+        lines.watcher = nullptr;
+}
+
+i_device& input_recorder::tap(i_device& device)
+{
+    return *taps.emplace_back(std::make_unique<tap_device>(*this, device));
+}
+
+void input_recorder::log_read(uint8_t byte)
+{
+    const size_t now = cycles();
+    put(log, (now - last_cycle) << kind_bits | 0);
+    log.push_back(byte);
+    last_cycle = now;
+}
+
+void input_recorder::lines_changed(const interrupt_lines& lines)
+{
+    // devices drive the same levels again on every update
+    if (lines.get_irq_sources() == irq_sources && lines.nmi() == nmi_level)
+        return;
+    irq_sources = lines.get_irq_sources();
+    nmi_level = lines.nmi();
+
+    const size_t now = cycles();
+    put(log, (now - last_cycle) << kind_bits | (in_access ? 1 : 2));
+    if (in_access) {
+        put(log, accesses - last_access);
+        last_access = accesses;
+    }
+    put(log, static_cast<uint64_t>(irq_sources) << 1 | nmi_level);
+    last_cycle = now;
+}
+
+input_player::input_player(std::vector<uint8_t> log, interrupt_lines& lines, cycle_source cycles)
+    : log(std::move(log))
+    , lines(lines)
+    , cycles(std::move(cycles))
+{
+    // a broken log is caught here, reading entries during the run can't fail anymore
+    entry check;
+    for (size_t at = 0; at < this->log.size();)
+        decode(this->log, at, check);
+
+    head.cycle = this->cycles();
+    next_entry();
+}
+
+uint8_t input_player::read(uint16_t)
+{
+    begin_access();
+    if (desynced)
+        return 0;
+    if (head.kind != entry_kind::read || head.cycle != cycles()) {
+        desync();
+        return 0;
+    }
+
+    const uint8_t byte = head.byte;
+    next_entry();
+    return byte;
+}
+
+void input_player::write(uint16_t, uint8_t)
+{
+    begin_access();
+}
+
+void input_player::begin_access()
+{
+    accesses++;
+    while (!desynced && head.kind == entry_kind::lines_in_access && head.access == accesses) {
+        if (head.cycle != cycles()) {
+            desync();
+            return;
+        }
+        apply_lines(head);
+        next_entry();
+    }
+}
+
+void input_player::apply_between(size_t now)
+{
+    while (!desynced && head.kind == entry_kind::lines_between && head.cycle <= now) {
+        if (head.cycle != now) {
+            desync();
+            return;
+        }
+        apply_lines(head);
+        next_entry();
+    }
+}
+
+void input_player::desync()
+{
+    // the deadline run reads moves to zero, the cpu stops after the instruction
+    desynced = true;
+    deadline = 0;
+    lines.pending |= interrupt_lines::pending_event;
+}
+
+void input_player::apply_lines(const entry& change)
+{
+    lines.set_irq(~change.irq_sources, false);
+    lines.set_irq(change.irq_sources, true);
+    lines.set_nmi(change.nmi_level);
+}
+
+void input_player::next_entry()
+{
+    if (position == log.size()) {
+        head.kind = entry_kind::end;
+        deadline = std::numeric_limits<size_t>::max();
+        return;
+    }
+
+    decode(log, position, head);
+
+    // a change between instructions ends the slice the cpu is running
+    const size_t before = deadline;
+    deadline = head.kind == entry_kind::lines_between ? head.cycle : std::numeric_limits<size_t>::max();
+    if (deadline < before)
+        lines.pending |= interrupt_lines::pending_event;
+}
+
+void input_player::decode(const std::vector<uint8_t>& log, size_t& position, entry& next)
+{
+    const uint64_t header = get(log, position);
+    next.kind = static_cast<entry_kind>(header & ((1 << kind_bits) - 1));
+    next.cycle += header >> kind_bits;
+    switch (next.kind) {
+    case entry_kind::read:
+        if (position == log.size())
+            throw std::runtime_error("replay log cut short");
+        next.byte = log[position++];
+        break;
+    case entry_kind::lines_in_access:
+        next.access += get(log, position);
+        [[fallthrough]];
+    case entry_kind::lines_between: {
+        const uint64_t levels = get(log, position);
+        next.irq_sources = static_cast<uint32_t>(levels >> 1);
+        next.nmi_level = levels & 1;
+        break;
+    }
+    default:
+        throw std::runtime_error("replay log entry unknown");
+    }
+}
+
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "types.h"
+#include "i_bus.h"
+#include "i_device.h"
+#include "interrupt_lines.h"
+
+namespace emulator {
+
+// logs the device reads and interrupt line changes of a run with the cycle of each
+class input_recorder final : public interrupt_lines::observer {
+public:
+    using cycle_source = std::function<size_t()>; // usually basic_cpu6502::get_cycles
+
+    // watches lines until destroyed, lines must outlive it
+    input_recorder(interrupt_lines& lines, cycle_source cycles);
+    ~input_recorder();
+
+    // a stand-in to map in place of device, passes every access on and logs what reads return,
+    // it lives as long as the recorder
+    i_device& tap(i_device& device);
+
+    const std::vector<uint8_t>& get_log() const { return log; } // LEB128 entries, each led by its cycle delta and kind
+
+    void lines_changed(const interrupt_lines& lines) override;
+
+private:
+    class tap_device;
+
+    void log_read(uint8_t byte);
+    void begin_access() { accesses++; }
+
+    interrupt_lines& lines;
+    cycle_source cycles;
+    std::vector<std::unique_ptr<tap_device>> taps;
+    std::vector<uint8_t> log;
+    size_t last_cycle {};
+    size_t accesses {}; // counts device reads and writes, the one in progress included
+    size_t last_access {}; // of the last line change logged within an access
+    bool in_access = false;
+    uint32_t irq_sources {}; // the line levels logged last
+    bool nmi_level = false;
+};
+
+// plays a log back in place of the recorded devices and stops the run on the first input that doesn't fit it
+class input_player final : public i_device {
+public:
+    using cycle_source = std::function<size_t()>;
+
+    input_player(std::vector<uint8_t> log, interrupt_lines& lines, cycle_source cycles); // throws std::runtime_error on a broken log
+
+    uint8_t read(uint16_t address) override;
+    void write(uint16_t address, uint8_t byte) override;
+
+    // runs cpu until its bus address reaches stop like Cpu::run, stopping between instructions
+    // where a line change has to go in, returns how the last slice ended with the cycles of the whole run,
+    // a desync ends it on stop_reason::deadline
+    template <typename Cpu>
+    auto run(Cpu& cpu, uint16_t stop)
+    {
+        typename Cpu::run_result result;
+        size_t cycles {};
+        while (true) {
+            result = cpu.run(stop, deadline);
+            cycles += result.cycles;
+            if (result.reason != Cpu::stop_reason::deadline || desynced)
+                break;
+            apply_between(cpu.clock.get_cycles());
+        }
+        result.cycles = cycles;
+        return result;
+    }
+
+    bool is_done() const { return head.kind == entry_kind::end; } // every input was fed back
+    bool is_desynced() const { return desynced; }
+
+private:
+    enum class entry_kind : uint8_t {
+        read,
+        lines_in_access,
+        lines_between,
+        end
+    };
+
+    struct entry {
+        entry_kind kind = entry_kind::end;
+        size_t cycle {};
+        uint8_t byte {};
+        size_t access {};
+        uint32_t irq_sources {};
+        bool nmi_level = false;
+    };
+
+    void begin_access();
+    void apply_between(size_t now);
+    void apply_lines(const entry& change);
+    void desync();
+    void next_entry();
+    static void decode(const std::vector<uint8_t>& log, size_t& position, entry& next);
+
+    std::vector<uint8_t> log;
+    size_t position {};
+    interrupt_lines& lines;
+    cycle_source cycles;
+    entry head;
+    size_t accesses {};
+    size_t deadline = std::numeric_limits<size_t>::max(); // of head when it goes in between instructions, run reads it through a reference
+    bool desynced = false;
+};
+
+// FNV-1a over the clock, the registers and the memory, two runs that end on the same hash ended the same way
+template <typename Cpu, typename Bus>
+uint64_t state_hash(Cpu& cpu, const Bus& bus)
+{
+    auto image = std::make_unique<memory_image>();
+    bus.snapshot(*image);
+
+    uint64_t hash = 0xCBF29CE484222325;
+    auto add = [&hash](uint8_t byte) { hash = (hash ^ byte) * 0x100000001B3; };
+    const size_t cycles = cpu.clock.get_cycles();
+    for (size_t i = 0; i < sizeof(cycles); i++)
+        add(static_cast<uint8_t>(cycles >> (i * 8)));
+    add(static_cast<uint8_t>(cpu.PC));
+    add(static_cast<uint8_t>(cpu.PC >> 8));
+    add(cpu.A);
+    add(cpu.X);
+    add(cpu.Y);
+    add(cpu.S);
+    add(std::bit_cast<uint8_t>(cpu.get_status()));
+    for (uint8_t byte : *image)
+        add(byte);
+    return hash;
+}
+
+}
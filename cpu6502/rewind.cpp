@@ -0,0 +1,160 @@
+#include "rewind.h"
+
+namespace emulator {
+
+namespace {
+
+// a literal ends at the first run of this many zeros, shorter ones cost less inside it than two counts
+constexpr size_t min_zero_run = 4;
+
+size_t footprint(const std::vector<uint8_t>& memory)
+{
+    return memory.capacity();
+}
+
+}
+
+rewind_buffer::rewind_buffer(size_t interval, size_t budget, size_t group)
+    : interval(interval)
+    , budget(budget)
+    , group(group)
+    , image(std::make_unique<memory_image>())
+    , key(std::make_unique<memory_image>())
+    , delta(std::make_unique<memory_image>())
+{
+    if (interval == 0 || group == 0)
+        throw std::invalid_argument("interval and group must not be 0");
+}
+
+void rewind_buffer::clear()
+{
+    frames.clear();
+    bytes = 0;
+    since_key = 0;
+}
+
+size_t rewind_buffer::get_first_cycle() const
+{
+    return frames.empty() ? no_snapshot : frames.front().state.cycles;
+}
+
+size_t rewind_buffer::get_last_cycle() const
+{
+    return frames.empty() ? no_snapshot : frames.back().state.cycles;
+}
+
+void rewind_buffer::push(const cpu6502_base::cpu_state& state)
+{
+    // a capture after seeking back starts the history over from there
+    bool truncated = false;
+    while (!frames.empty() && frames.back().state.cycles >= state.cycles) {
+        bytes -= sizeof(frame) + footprint(frames.back().memory);
+        frames.pop_back();
+        truncated = true;
+    }
+
+    frame& added = frames.emplace_back(frame { state, false, {} });
+    if (frames.size() == 1 || truncated || since_key == group) {
+        added.key = true;
+        *key = *image;
+        encode(*image, added.memory);
+        since_key = 0;
+    } else {
+        for (size_t i = 0; i < image->size(); i++)
+            (*delta)[i] = (*image)[i] ^ (*key)[i];
+        encode(*delta, added.memory);
+    }
+    since_key++;
+
+    added.memory.shrink_to_fit();
+    bytes += sizeof(frame) + footprint(added.memory);
+    evict();
+}
+
+void rewind_buffer::evict()
+{
+    while (bytes > budget) {
+        // the deltas go with their keyframe
+        const auto next = std::find_if(frames.begin() + 1, frames.end(), [](const frame& f) { return f.key; });
+        if (next == frames.end())
+            break;
+        for (auto it = frames.begin(); it != next; ++it)
+            bytes -= sizeof(frame) + footprint(it->memory);
+        frames.erase(frames.begin(), next);
+    }
+}
+
+size_t rewind_buffer::find(size_t cycle) const
+{
+    const auto after = std::upper_bound(frames.begin(), frames.end(), cycle,
+        [](size_t cycle, const frame& f) { return cycle < f.state.cycles; });
+    return after == frames.begin() ? no_snapshot : static_cast<size_t>(after - frames.begin()) - 1;
+}
+
+void rewind_buffer::decode(size_t index)
+{
+    size_t first = index;
+    while (!frames[first].key)
+        first--;
+
+    image->fill(0);
+    apply(frames[first].memory, *image);
+    if (first != index)
+        apply(frames[index].memory, *image);
+}
+
+void rewind_buffer::encode(const memory_image& delta, std::vector<uint8_t>& out)
+{
+    auto put = [&out](size_t count) {
+        for (; count >= 0x80; count >>= 7)
+            out.push_back(static_cast<uint8_t>(count | 0x80));
+        out.push_back(static_cast<uint8_t>(count));
+    };
+
+    out.clear();
+    size_t i = 0;
+    while (i < delta.size()) {
+        // most of the memory matches the keyframe, zeros go a word at a time
+        size_t start = i;
+        uint64_t word;
+        while (i + 8 <= delta.size() && (std::memcpy(&word, &delta[i], 8), word == 0))
+            i += 8;
+        while (i < delta.size() && delta[i] == 0)
+            i++;
+        put(i - start);
+
+        start = i;
+        size_t zeros = 0;
+        while (i < delta.size() && zeros < min_zero_run) {
+            zeros = delta[i] ? 0 : zeros + 1;
+            i++;
+        }
+        i -= zeros;
+        put(i - start);
+        out.insert(out.end(), delta.begin() + start, delta.begin() + i);
+    }
+}
+
+void rewind_buffer::apply(const std::vector<uint8_t>& in, memory_image& image)
+{
+    size_t next = 0;
+    auto get = [&in, &next]() {
+        size_t count = 0;
+        for (size_t shift = 0;; shift += 7) {
+            const uint8_t byte = in[next++];
+            count |= static_cast<size_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return count;
+        }
+    };
+
+    size_t address = 0;
+    while (next < in.size()) {
+        address += get();
+        const size_t count = get();
+        for (size_t i = 0; i < count; i++)
+            image[address++] ^= in[next++];
+    }
+}
+
+}
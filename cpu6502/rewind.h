@@ -0,0 +1,105 @@
+#pragma once
+
+#include "types.h"
+#include "i_bus.h"
+#include "cpu6502.h"
+
+namespace emulator {
+
+// snapshots of a machine every interval cycles, stored as run-length encoded deltas against a keyframe
+class rewind_buffer {
+public:
+    // group counts the snapshots per keyframe, the keyframe included
+    rewind_buffer(size_t interval, size_t budget, size_t group = 64);
+
+    // a snapshot of a machine between two instructions, snapshots later than it are dropped
+    template <typename Cpu, typename Bus>
+    void capture(Cpu& cpu, const Bus& bus)
+    {
+        bus.snapshot(*image);
+        push(cpu.save());
+    }
+
+    // runs cpu until its bus address reaches stop like Cpu::run, capturing at its start and then on every multiple of interval,
+    // returns how the last slice ended with the cycles of the whole run
+    template <typename Cpu, typename Bus>
+    auto run(Cpu& cpu, Bus& bus, uint16_t stop)
+    {
+        size_t next = next_capture(cpu.clock.get_cycles());
+        if (frames.empty() || frames.back().state.cycles != cpu.clock.get_cycles())
+            capture(cpu, bus);
+
+        typename Cpu::run_result result;
+        size_t cycles {};
+        while (true) {
+            result = cpu.run(stop, next);
+            cycles += result.cycles;
+            if (result.reason != Cpu::stop_reason::deadline)
+                break;
+            capture(cpu, bus);
+            next = next_capture(cpu.clock.get_cycles());
+        }
+        result.cycles = cycles;
+        return result;
+    }
+
+    // restores the last snapshot at or before cycle and runs forward to the first instruction boundary at or after it,
+    // or to stop like the recorded run, the machine has to replay the same way so devices other than memory are not covered,
+    // false when cycle is before the window
+    template <typename Cpu, typename Bus>
+    bool seek(Cpu& cpu, Bus& bus, size_t cycle, uint16_t stop)
+    {
+        const size_t index = find(cycle);
+        if (index == no_snapshot)
+            return false;
+
+        const cpu6502_base::cpu_state& state = frames[index].state;
+        decode(index);
+        bus.restore(*image);
+        cpu.restore(state);
+        if (cycle > state.cycles)
+            cpu.run({ .address = stop, .cycles = cycle - state.cycles });
+        return true;
+    }
+
+    void clear();
+
+    size_t size() const { return frames.size(); }
+    size_t get_bytes() const { return bytes; } // encoded memory and frame records
+    size_t get_first_cycle() const; // the window, no_snapshot when empty
+    size_t get_last_cycle() const;
+
+    static constexpr size_t no_snapshot = std::numeric_limits<size_t>::max();
+
+private:
+    struct frame {
+        cpu6502_base::cpu_state state;
+        bool key;
+        std::vector<uint8_t> memory;
+    };
+
+    size_t next_capture(size_t cycles) const { return (cycles / interval + 1) * interval; }
+
+    void push(const cpu6502_base::cpu_state& state); // memory comes from image
+    void evict();
+    size_t find(size_t cycle) const; // no_snapshot when cycle is before the window
+    void decode(size_t index); // into image
+
+    // zero run, literal count, literal bytes, repeated up to the end of the image, counts as LEB128
+    static void encode(const memory_image& delta, std::vector<uint8_t>& out);
+    static void apply(const std::vector<uint8_t>& in, memory_image& image); // XORs the literals in
+
+    size_t interval;
+    size_t budget; // in bytes, the oldest group is dropped to stay under it
+    size_t group;
+
+    std::deque<frame> frames;
+    size_t bytes {};
+    size_t since_key {}; // snapshots since the last keyframe, the keyframe included
+
+    std::unique_ptr<memory_image> image; // the snapshot being captured or restored
+    std::unique_ptr<memory_image> key; // the memory of the last keyframe
+    std::unique_ptr<memory_image> delta;
+};
+
+}
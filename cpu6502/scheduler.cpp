@@ -0,0 +1,117 @@
+#include "scheduler.h"
+
+namespace emulator {
+
+scheduler::event_id scheduler::add(handler_t handler)
+{
+    handlers.push_back(std::move(handler));
+    positions.push_back(idle);
+    return handlers.size() - 1;
+}
+
+void scheduler::schedule(event_id event, size_t cycle)
+{
+    size_t index = positions.at(event);
+    if (index == idle) {
+        index = heap.size();
+        heap.push_back({});
+    }
+
+    place(index, { cycle, event });
+    sift_up(index);
+    sift_down(positions[event]);
+    update_next();
+}
+
+void scheduler::cancel(event_id event)
+{
+    const size_t index = positions.at(event);
+    if (index != idle)
+        remove(index);
+}
+
+bool scheduler::is_scheduled(event_id event) const
+{
+    return positions.at(event) != idle;
+}
+
+size_t scheduler::get_deadline(event_id event) const
+{
+    const size_t index = positions.at(event);
+    return index == idle ? never : heap[index].cycle;
+}
+
+void scheduler::dispatch(size_t now)
+{
+    // an event rescheduled at or before now by its own handler runs again in this call
+    while (!heap.empty() && heap.front().cycle <= now) {
+        const entry due = heap.front();
+        remove(0);
+        handlers[due.event](due.cycle);
+    }
+}
+
+bool scheduler::before(const entry& a, const entry& b)
+{
+    return a.cycle != b.cycle ? a.cycle < b.cycle : a.event < b.event;
+}
+
+void scheduler::place(size_t index, const entry& item)
+{
+    heap[index] = item;
+    positions[item.event] = index;
+}
+
+void scheduler::sift_up(size_t index)
+{
+    const entry item = heap[index];
+    while (index > 0) {
+        const size_t parent = (index - 1) / 2;
+        if (!before(item, heap[parent]))
+            break;
+        place(index, heap[parent]);
+        index = parent;
+    }
+    place(index, item);
+}
+
+void scheduler::sift_down(size_t index)
+{
+    const entry item = heap[index];
+    while (true) {
+        size_t child = 2 * index + 1;
+        if (child >= heap.size())
+            break;
+        if (child + 1 < heap.size() && before(heap[child + 1], heap[child]))
+            child++;
+        if (!before(heap[child], item))
+            break;
+        place(index, heap[child]);
+        index = child;
+    }
+    place(index, item);
+}
+
+void scheduler::remove(size_t index)
+{
+    positions[heap[index].event] = idle;
+
+    const entry last = heap.back();
+    heap.pop_back();
+    if (index != heap.size()) {
+        place(index, last);
+        sift_up(index);
+        sift_down(positions[last.event]);
+    }
+    update_next();
+}
+
+void scheduler::update_next()
+{
+    const size_t before = next;
+    next = heap.empty() ? never : heap.front().cycle;
+    if (running && next < before)
+        running->pending |= interrupt_lines::pending_event;
+}
+
+}
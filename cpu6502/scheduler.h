@@ -0,0 +1,71 @@
+#pragma once
+
+#include "types.h"
+#include "interrupt_lines.h"
+
+namespace emulator {
+
+// device events keyed by absolute clock cycle, the cpu runs uninterrupted up to the next deadline
+// instead of devices ticking on every cycle, events live in a binary min-heap that tracks
+// each event's position so schedule, reschedule and cancel are all O(log n)
+class scheduler {
+public:
+    using event_id = size_t;
+    using handler_t = std::function<void(size_t cycle)>; // gets the cycle the event was due at
+
+    static constexpr size_t never = std::numeric_limits<size_t>::max();
+
+    // registers an event, it stays idle until scheduled
+    event_id add(handler_t handler);
+
+    // schedules or moves the event to an absolute cycle
+    void schedule(event_id event, size_t cycle);
+    void cancel(event_id event);
+
+    bool is_scheduled(event_id event) const;
+    size_t get_deadline(event_id event) const; // never when idle
+    size_t next_deadline() const { return next; } // never when nothing is scheduled
+
+    // runs every event due at or before now in cycle order, handlers may schedule and cancel
+    void dispatch(size_t now);
+
+    // runs cpu until its bus address reaches stop or it halts, stopping at every deadline to dispatch the events due,
+    // a device scheduling an earlier event while the cpu runs cuts the slice short through pending_event,
+    // returns how the last slice ended
+    template <typename Cpu>
+    auto run(Cpu& cpu, uint16_t stop)
+    {
+        running = &cpu.interrupts;
+        typename Cpu::run_result result;
+        do {
+            dispatch(cpu.clock.get_cycles());
+            result = cpu.run(stop, next);
+        } while (result.reason == Cpu::stop_reason::deadline);
+        running = nullptr;
+        return result;
+    }
+
+private:
+    static constexpr size_t idle = std::numeric_limits<size_t>::max();
+
+    struct entry {
+        size_t cycle;
+        event_id event; // breaks ties so events due together run in the order they were added
+    };
+
+    static bool before(const entry& a, const entry& b);
+
+    void place(size_t index, const entry& item);
+    void sift_up(size_t index);
+    void sift_down(size_t index);
+    void remove(size_t index);
+    void update_next();
+
+    std::vector<entry> heap;
+    std::vector<handler_t> handlers;
+    std::vector<size_t> positions; // heap index per event, idle when not scheduled
+    size_t next = never; // the heap's first deadline, the running cpu reads it through a reference
+    interrupt_lines* running = nullptr;
+};
+
+}
@@ -0,0 +1,49 @@
+#include "trace.h"
+#include "cpu6502.h"
+
+namespace emulator {
+
+trace_ring::trace_ring(size_t capacity)
+    : records(std::bit_ceil(std::max<size_t>(capacity, 1)))
+    , mask(records.size() - 1)
+{
+}
+
+std::string trace_ring::format(const trace_record& record, bool same_cycle)
+{
+    const std::string cycle = std::to_string(record.cycle);
+    const cpu6502_base::status P = std::bit_cast<cpu6502_base::status>(record.P);
+
+    std::stringstream ss;
+    ss << "oc: " << cpu6502_base::mnemonics.at(record.oc)
+       << " cycle: " << (same_cycle ? std::string(cycle.size(), '-') : cycle)
+       << " PC: " << std::format("{:#06x}", record.pc)
+       << " r/w: " << record.control
+       << " address: " << std::format("{:#06x}", record.address)
+       << " data: " << std::format("{:#04x}", record.data)
+       << " A: " << std::format("{:#04x}", record.A)
+       << " X: " << std::format("{:#04x}", record.X)
+       << " Y: " << std::format("{:#04x}", record.Y)
+       << " S: " << std::format("{:#04x}", record.S)
+       << " NV_BDIZC: "
+       << std::to_string(P.N)
+       << std::to_string(P.V)
+       << std::to_string(P._)
+       << std::to_string(P.B)
+       << std::to_string(P.D)
+       << std::to_string(P.I)
+       << std::to_string(P.Z)
+       << std::to_string(P.C);
+    return ss.str();
+}
+
+void trace_ring::dump(std::ostream& out) const
+{
+    for (size_t position = 0; position < size(); position++) {
+        const trace_record& record = (*this)[position];
+        const bool same_cycle = position && (*this)[position - 1].cycle == record.cycle;
+        out << format(record, same_cycle) << '\n';
+    }
+}
+
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "types.h"
+
+namespace emulator {
+
+// one traced instruction, registers and buses as it left them
+struct trace_record {
+    uint64_t cycle;
+    uint16_t pc; // where the instruction started
+    uint16_t address; // the last bus access
+    uint8_t oc;
+    uint8_t A;
+    uint8_t X;
+    uint8_t Y;
+    uint8_t S;
+    uint8_t P;
+    uint8_t data;
+    bool control; // r/w of the last bus access
+};
+static_assert(sizeof(trace_record) == 24);
+
+// the last instructions a cpu ran, see basic_cpu6502::enable_trace, records are copied in as they are
+// and turned into text only when dumped, the oldest is overwritten once it is full
+class trace_ring {
+public:
+    explicit trace_ring(size_t capacity); // rounded up to a power of two
+
+    void push(const trace_record& record)
+    {
+        records[next++ & mask] = record;
+    }
+
+    void clear() { next = 0; }
+
+    size_t size() const { return std::min<size_t>(next, records.size()); }
+    size_t capacity() const { return records.size(); }
+    const trace_record& operator[](size_t position) const { return records[(next - size() + position) & mask]; } // oldest first
+
+    // a cycle the previous line already showed is dashed out
+    static std::string format(const trace_record& record, bool same_cycle = false);
+    void dump(std::ostream& out) const;
+
+private:
+    std::vector<trace_record> records;
+    size_t mask;
+    uint64_t next {}; // records pushed since the last clear
+};
+
+}
@@ -0,0 +1,207 @@
+#include "via6522.h"
+
+namespace emulator {
+
+static uint8_t lo_byte(uint16_t word)
+{
+    return static_cast<uint8_t>(word);
+}
+
+static uint8_t hi_byte(uint16_t word)
+{
+    return static_cast<uint8_t>(word >> 8);
+}
+
+via6522::via6522(cycle_source cycles, scheduler& events, interrupt_lines& lines, uint32_t source)
+    : catch_up_device(std::move(cycles))
+    , events(events)
+    , lines(lines)
+    , source(source)
+{
+    underflow = events.add([this](size_t) { sync(); });
+}
+
+via6522::~via6522()
+{
+    events.cancel(underflow);
+}
+
+void via6522::advance(size_t cycles)
+{
+    advance_t1(cycles);
+    advance_t2(cycles);
+    update_irq();
+}
+
+void via6522::advance_t1(size_t cycles)
+{
+    // one-shot keeps counting down through FFFF
+    if (!(acr & acr_t1_free_run)) {
+        if (cycles > t1_counter && t1_armed) {
+            t1_armed = false;
+            ifr |= irq_t1;
+        }
+        t1_counter = static_cast<uint16_t>(t1_counter - cycles);
+        return;
+    }
+
+    // free-run goes N .. 0, FFFF, then the latch again, a period of latch + 2 cycles
+    size_t left = cycles;
+    if (!t1_reload) {
+        if (left <= t1_counter) {
+            t1_counter = static_cast<uint16_t>(t1_counter - left);
+            return;
+        }
+        left -= t1_counter + 1;
+        ifr |= irq_t1;
+    }
+
+    const size_t period = t1_latch + 2;
+    if (left >= period)
+        ifr |= irq_t1;
+    left %= period;
+
+    t1_reload = left == 0;
+    t1_counter = t1_reload ? 0xFFFF : static_cast<uint16_t>(t1_latch - (left - 1));
+}
+
+void via6522::advance_t2(size_t cycles)
+{
+    if (acr & acr_t2_pulses)
+        return;
+
+    if (cycles > t2_counter && t2_armed) {
+        t2_armed = false;
+        ifr |= irq_t2;
+    }
+    t2_counter = static_cast<uint16_t>(t2_counter - cycles);
+}
+
+uint8_t via6522::read_register(uint16_t address)
+{
+    switch (address & 0x0F) {
+    case ORB:
+        return get_port_b();
+    case ORA:
+    case ORA_NH:
+        return get_port_a();
+    case DDRB:
+        return ddrb;
+    case DDRA:
+        return ddra;
+    case T1CL:
+        ifr &= ~irq_t1;
+        update_irq();
+        return lo_byte(t1_counter);
+    case T1CH:
+        return hi_byte(t1_counter);
+    case T1LL:
+        return lo_byte(t1_latch);
+    case T1LH:
+        return hi_byte(t1_latch);
+    case T2CL:
+        ifr &= ~irq_t2;
+        update_irq();
+        return lo_byte(t2_counter);
+    case T2CH:
+        return hi_byte(t2_counter);
+    case SR:
+        return sr;
+    case ACR:
+        return acr;
+    case PCR:
+        return pcr;
+    case IFR:
+        return ifr | ((ifr & ier) ? 0x80 : 0x00);
+    default:
+        return ier | 0x80;
+    }
+}
+
+void via6522::write_register(uint16_t address, uint8_t byte)
+{
+    switch (address & 0x0F) {
+    case ORB:
+        orb = byte;
+        break;
+    case ORA:
+    case ORA_NH:
+        ora = byte;
+        break;
+    case DDRB:
+        ddrb = byte;
+        break;
+    case DDRA:
+        ddra = byte;
+        break;
+    case T1CL:
+    case T1LL:
+        t1_latch = (t1_latch & 0xFF00) | byte;
+        break;
+    case T1CH:
+        // loads the counter from the latch and starts it
+        t1_latch = static_cast<uint16_t>((t1_latch & 0x00FF) | (byte << 8));
+        t1_counter = t1_latch;
+        t1_reload = false;
+        t1_armed = true;
+        ifr &= ~irq_t1;
+        break;
+    case T1LH:
+        t1_latch = static_cast<uint16_t>((t1_latch & 0x00FF) | (byte << 8));
+        ifr &= ~irq_t1;
+        break;
+    case T2CL:
+        t2_latch = byte;
+        break;
+    case T2CH:
+        t2_counter = static_cast<uint16_t>((byte << 8) | t2_latch);
+        t2_armed = true;
+        ifr &= ~irq_t2;
+        break;
+    case SR:
+        sr = byte;
+        break;
+    case ACR:
+        // leaving free-run in the FFFF cycle just goes on counting down from there
+        if (!(byte & acr_t1_free_run))
+            t1_reload = false;
+        acr = byte;
+        break;
+    case PCR:
+        pcr = byte;
+        break;
+    case IFR:
+        ifr &= ~byte & 0x7F;
+        break;
+    default:
+        // bit 7 picks between setting and clearing the other bits
+        ier = (byte & 0x80) ? (ier | byte) & 0x7F : ier & ~byte;
+        break;
+    }
+
+    update_irq();
+}
+
+void via6522::update_irq()
+{
+    lines.set_irq(source, ifr & ier);
+
+    // a flag already set changes nothing until it is cleared, which comes back here
+    const size_t now = get_synced();
+    size_t next = scheduler::never;
+    if ((ier & irq_t1) && !(ifr & irq_t1)) {
+        if (acr & acr_t1_free_run)
+            next = now + (t1_reload ? t1_latch + 2 : t1_counter + 1);
+        else if (t1_armed)
+            next = now + t1_counter + 1;
+    }
+    if ((ier & irq_t2) && !(ifr & irq_t2) && t2_armed && !(acr & acr_t2_pulses))
+        next = std::min(next, now + t2_counter + 1);
+
+    if (next == scheduler::never)
+        events.cancel(underflow);
+    else
+        events.schedule(underflow, next);
+}
+
+}
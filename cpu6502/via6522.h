@@ -0,0 +1,89 @@
+#pragma once
+
+#include "types.h"
+#include "catch_up_device.h"
+#include "interrupt_lines.h"
+#include "scheduler.h"
+
+namespace emulator {
+
+// MOS 6522 VIA as a catch-up device, without the handshake lines, PB7 output, T2 pulse counting or shift register
+class via6522 final : public catch_up_device {
+public:
+    // repeated over every mapped page
+    enum reg : uint8_t {
+        ORB,
+        ORA,
+        DDRB,
+        DDRA,
+        T1CL,
+        T1CH,
+        T1LL,
+        T1LH,
+        T2CL,
+        T2CH,
+        SR,
+        ACR,
+        PCR,
+        IFR,
+        IER,
+        ORA_NH // ORA without handshake
+    };
+
+    static constexpr uint8_t irq_t2 = 1 << 5;
+    static constexpr uint8_t irq_t1 = 1 << 6;
+    static constexpr uint8_t acr_t2_pulses = 1 << 5;
+    static constexpr uint8_t acr_t1_free_run = 1 << 6;
+
+    // source is the IRQ line bit this chip drives, events and lines must outlive it
+    via6522(cycle_source cycles, scheduler& events, interrupt_lines& lines, uint32_t source = 1);
+    ~via6522() override;
+
+    // input levels on the pins, lines nothing drives read high
+    void set_port_a(uint8_t pins) { pins_a = pins; }
+    void set_port_b(uint8_t pins) { pins_b = pins; }
+
+    // what the port shows, output bits from OR, input bits from the pins
+    uint8_t get_port_a() const { return (ora & ddra) | (pins_a & ~ddra); }
+    uint8_t get_port_b() const { return (orb & ddrb) | (pins_b & ~ddrb); }
+
+private:
+    void advance(size_t cycles) override;
+    uint8_t read_register(uint16_t address) override;
+    void write_register(uint16_t address, uint8_t byte) override;
+
+    // worked out from the cycles passed instead of counted down
+    void advance_t1(size_t cycles);
+    void advance_t2(size_t cycles);
+
+    // drives the IRQ line and moves the event to the next underflow that can raise it
+    void update_irq();
+
+    scheduler& events;
+    interrupt_lines& lines;
+    uint32_t source {};
+    scheduler::event_id underflow {};
+
+    uint8_t orb {};
+    uint8_t ora {};
+    uint8_t ddrb {};
+    uint8_t ddra {};
+    uint8_t pins_a = 0xFF;
+    uint8_t pins_b = 0xFF;
+    uint8_t sr {};
+    uint8_t acr {};
+    uint8_t pcr {};
+    uint8_t ifr {}; // bits 0-6, bit 7 is worked out on read
+    uint8_t ier {};
+
+    uint16_t t1_counter {};
+    uint16_t t1_latch {};
+    bool t1_armed = false; // one-shot mode interrupts once per load
+    bool t1_reload = false; // free-run mode, the cycle after underflow shows FFFF and reloads next
+
+    uint16_t t2_counter {};
+    uint8_t t2_latch {}; // low byte, T2 has no high latch
+    bool t2_armed = false;
+};
+
+}
@@ -0,0 +1,61 @@
+#include "write_journal.h"
+
+namespace emulator {
+
+write_journal::write_journal()
+    : index(std::make_unique<std::array<std::vector<size_t>, 64 * 1024>>())
+{
+}
+
+void write_journal::clear()
+{
+    chunks.clear();
+    count = 0;
+    for (auto& positions : *index)
+        positions = {};
+}
+
+std::vector<size_t>::const_iterator write_journal::first_at(const std::vector<size_t>& positions, size_t cycle) const
+{
+    return std::partition_point(positions.begin(), positions.end(),
+        [this, cycle](size_t position) { return (*this)[position].cycle < cycle; });
+}
+
+std::optional<write_journal::entry> write_journal::last_write(uint16_t address, size_t before) const
+{
+    const std::vector<size_t>& positions = (*index)[address];
+    const auto first = first_at(positions, before);
+    if (first == positions.begin())
+        return std::nullopt;
+    return (*this)[*std::prev(first)];
+}
+
+std::vector<write_journal::entry> write_journal::writes(uint16_t address, size_t from, size_t to) const
+{
+    const std::vector<size_t>& positions = (*index)[address];
+    std::vector<entry> found;
+    for (auto it = first_at(positions, from); it != positions.end() && (*this)[*it].cycle < to; ++it)
+        found.push_back((*this)[*it]);
+    return found;
+}
+
+std::vector<write_journal::entry> write_journal::writes(size_t from, size_t to) const
+{
+    // the log itself is in cycle order
+    size_t low = 0;
+    size_t high = count;
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        if ((*this)[middle].cycle < from)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    std::vector<entry> found;
+    for (size_t position = low; position < count && (*this)[position].cycle < to; position++)
+        found.push_back((*this)[position]);
+    return found;
+}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "types.h"
+
+namespace emulator {
+
+// every write the cpu makes, see basic_cpu6502::enable_write_journal, appended in chunks that never move,
+// the writes to each address are indexed in log order, cycles never go back within a run
+// so every query is a binary search, a restore that takes the clock back should clear it
+class write_journal {
+public:
+    struct entry {
+        size_t cycle; // the instruction's first cycle, the bus cycle when cycle accurate
+        uint16_t pc; // of the writing instruction, the return address IRQ and NMI push
+        uint16_t address;
+        uint8_t old; // what RAM held, the new byte again where no RAM is mapped
+        uint8_t value;
+    };
+
+    write_journal();
+
+    void record(const entry& write)
+    {
+        if (count % chunk_size == 0)
+            chunks.push_back(std::make_unique<chunk>());
+        (*chunks.back())[count % chunk_size] = write;
+        (*index)[write.address].push_back(count);
+        count++;
+    }
+
+    void clear();
+
+    size_t size() const { return count; }
+    const entry& operator[](size_t position) const { return (*chunks[position / chunk_size])[position % chunk_size]; }
+
+    // the last write to address before cycle
+    std::optional<entry> last_write(uint16_t address, size_t before) const;
+
+    // in log order, writes to address in [from, to), or to any address
+    std::vector<entry> writes(uint16_t address, size_t from, size_t to) const;
+    std::vector<entry> writes(size_t from, size_t to) const;
+
+private:
+    static constexpr size_t chunk_size = 4096;
+    using chunk = std::array<entry, chunk_size>;
+
+    // the first of positions whose write is at or after cycle
+    std::vector<size_t>::const_iterator first_at(const std::vector<size_t>& positions, size_t cycle) const;
+
+    std::vector<std::unique_ptr<chunk>> chunks;
+    size_t count {};
+    std::unique_ptr<std::array<std::vector<size_t>, 64 * 1024>> index; // log positions per address
+};
+
+}
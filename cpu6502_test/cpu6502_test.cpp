@@ -1,4 +1,5 @@
 #include "cpu6502_test.h"
+#include "machine.h"
 
 namespace emulator {
 
@@ -2004,12 +2005,560 @@ TEST_F(cpu6502_test, NOP_IMP)
     EXPECT_EQ(clock.get_cycles(), cpu.instructions.at(opcode).cycles);
 }
 
+TEST_F(cpu6502_test, instruction_accurate_ABX_with_carry)
+{
+    cpu.mode = cpu6502::execution_mode::instruction_accurate;
+    carry = true;
+    load_AB(oc::LDA_ABX, cpu.A, cpu.X);
+}
+
+TEST_F(cpu6502_test, instruction_accurate_branch_with_carry)
+{
+    auto opcode = oc::BNE____;
+
+    cpu.mode = cpu6502::execution_mode::instruction_accurate;
+    cpu.PC = 0x02FD;
+    bus.write(0x02FD, opcode);
+    bus.write(0x02FE, 0x10);
+    cpu.execute();
+
+    EXPECT_EQ(cpu.PC, 0x030F);
+    EXPECT_EQ(clock.get_cycles(), cpu.instructions.at(opcode).cycles + 2);
+}
+
+TEST_F(cpu6502_test, decode_cache_self_modifying_code)
+{
+    cpu.enable_decode_cache(true);
+
+    cpu.PC = 0x0210;
+    bus.write(0x0210, oc::INX_IMP);
+    cpu.execute();
+
+    EXPECT_EQ(cpu.X, 1);
+
+    cpu.PC = 0x0200;
+    create_IMM(oc::LDA_IMM, oc::INY_IMP);
+    bus.write(counter++, oc::STA_ABS);
+    bus.write(counter++, 0x10);
+    bus.write(counter++, 0x02);
+    cpu.execute();
+    cpu.execute();
+
+    cpu.PC = 0x0210;
+    cpu.execute();
+
+    EXPECT_EQ(cpu.X, 1);
+    EXPECT_EQ(cpu.Y, 1);
+}
+
+TEST_F(cpu6502_test, decode_cache_operand_rewrite)
+{
+    cpu.enable_decode_cache(true);
+
+    cpu.PC = 0x0210;
+    bus.write(0x0210, oc::LDX_ABS);
+    bus.write(0x0211, 0x00);
+    bus.write(0x0212, 0x40);
+    bus.write(0x4000, 0x0A);
+    bus.write(0x4100, 0x0B);
+    cpu.execute();
+
+    EXPECT_EQ(cpu.X, 0x0A);
+
+    cpu.PC = 0x0200;
+    create_IMM(oc::LDA_IMM, 0x41);
+    bus.write(counter++, oc::STA_ABS);
+    bus.write(counter++, 0x12);
+    bus.write(counter++, 0x02);
+    cpu.execute();
+    cpu.execute();
+
+    cpu.PC = 0x0210;
+    cpu.execute();
+
+    EXPECT_EQ(cpu.X, 0x0B);
+}
+
+TEST_F(cpu6502_test, JSR_overwrites_its_operand_on_the_stack_page)
+{
+    for (tier mode : tiers) {
+        SetUp();
+        cpu.mode = cpu6502::execution_mode::instruction_accurate;
+        if (!set_tier(cpu, mode))
+            continue;
+
+        // the return address high byte lands on the operand high byte before it is fetched
+        bus.write(0x01F0, oc::JSR____);
+        bus.write(0x01F1, 0x00);
+        bus.write(0x01F2, 0xD0);
+        bus.write(0x0100, oc::INX_IMP);
+        bus.write(0x0101, oc::JMP_ABS);
+        bus.write(0x0102, 0x00);
+        bus.write(0x0103, 0x03);
+        cpu.PC = 0x01F0;
+        cpu.S = 0xF2;
+        const auto result = cpu.run({ .address = 0x0300, .cycles = 100 });
+        EXPECT_EQ(result.reason, cpu6502::stop_reason::address);
+        EXPECT_EQ(cpu.X, 0x01);
+    }
+}
+
+TEST_F(cpu6502_test, block_mode_loop)
+{
+    cpu.mode = cpu6502::execution_mode::instruction_accurate;
+    cpu.enable_block_mode(true);
+
+    create_IMM(oc::LDX_IMM, 0x05);
+    bus.write(counter++, oc::INY_IMP);
+    bus.write(counter++, oc::DEX_IMP);
+    create_IMM(oc::BNE____, 0xFC);
+    bus.write(counter++, oc::JMP_ABS);
+    bus.write(counter++, 0x00);
+    bus.write(counter++, 0x03);
+    cpu.run(0x0300);
+
+    EXPECT_EQ(cpu.X, 0x00);
+    EXPECT_EQ(cpu.Y, 0x05);
+    EXPECT_EQ(cpu.PC, 0x0300);
+    EXPECT_EQ(clock.get_cycles(), 2 + 5 * 4 + 4 * 3 + 2 + 3);
+}
+
+TEST_F(cpu6502_test, block_mode_self_modifying_code)
+{
+    cpu.mode = cpu6502::execution_mode::instruction_accurate;
+    cpu.enable_block_mode(true);
+
+    create_IMM(oc::LDA_IMM, oc::INX_IMP);
+    bus.write(counter++, oc::STA_ABS);
+    bus.write(counter++, 0x05);
+    bus.write(counter++, 0x02);
+    bus.write(counter++, oc::NOP_IMP);
+    bus.write(counter++, oc::JMP_ABS);
+    bus.write(counter++, 0x00);
+    bus.write(counter++, 0x03);
+    cpu.run(0x0300);
+
+    EXPECT_EQ(cpu.X, 0x01);
+    EXPECT_EQ(cpu.PC, 0x0300);
+    EXPECT_EQ(clock.get_cycles(), 2 + 4 + 2 + 3);
+}
+
+TEST_F(cpu6502_test, block_mode_fused_compare_and_branch)
+{
+    cpu.mode = cpu6502::execution_mode::instruction_accurate;
+    cpu.enable_block_mode(true);
+
+    create_IMM(oc::LDX_IMM, 0x00);
+    bus.write(counter++, oc::INX_IMP);
+    bus.write(counter++, oc::TXA_IMP);
+    create_IMM(oc::CMP_IMM, 0x07);
+    create_IMM(oc::BNE____, 0xFA);
+    bus.write(counter++, oc::JMP_ABS);
+    bus.write(counter++, 0x00);
+    bus.write(counter++, 0x03);
+    cpu.run(0x0300);
+
+    EXPECT_EQ(cpu.X, 0x07);
+    EXPECT_EQ(cpu.PC, 0x0300);
+    EXPECT_EQ(clock.get_cycles(), 2 + 7 * 6 + 6 * 3 + 2 + 3);
+}
+
+TEST_F(cpu6502_test, block_mode_stop_inside_fused_pair)
+{
+    cpu.mode = cpu6502::execution_mode::instruction_accurate;
+    cpu.enable_block_mode(true);
+
+    // CMP #$07 leaves its operand address on the bus, the run ends before the BNE
+    create_IMM(oc::LDX_IMM, 0x00);
+    bus.write(counter++, oc::INX_IMP);
+    bus.write(counter++, oc::TXA_IMP);
+    create_IMM(oc::CMP_IMM, 0x07);
+    create_IMM(oc::BNE____, 0xFA);
+    cpu.run(0x0205);
+
+    EXPECT_EQ(cpu.X, 0x01);
+    EXPECT_EQ(cpu.PC, 0x0206);
+    EXPECT_EQ(clock.get_cycles(), 2 + 2 + 2 + 2);
+}
+
+TEST_F(cpu6502_test, bigram_profile)
+{
+    cpu.mode = cpu6502::execution_mode::instruction_accurate;
+    cpu.enable_bigram_profile(true);
+
+    create_IMM(oc::LDY_IMM, 0x03);
+    bus.write(counter++, oc::DEY_IMP);
+    create_IMM(oc::BNE____, 0xFD);
+    bus.write(counter++, oc::JMP_ABS);
+    bus.write(counter++, 0x00);
+    bus.write(counter++, 0x03);
+    cpu.run(0x0300);
+
+    const auto top = cpu.top_bigrams(2);
+    ASSERT_EQ(top.size(), 2);
+    EXPECT_EQ(top[0].first, oc::DEY_IMP);
+    EXPECT_EQ(top[0].second, oc::BNE____);
+    EXPECT_EQ(top[0].count, 3);
+    EXPECT_EQ(top[1].first, oc::BNE____);
+    EXPECT_EQ(top[1].second, oc::DEY_IMP);
+    EXPECT_EQ(top[1].count, 2);
+}
+
+TEST_F(cpu6502_test, status_view_across_run)
+{
+    cpu.mode = cpu6502::execution_mode::instruction_accurate;
+    cpu.enable_block_mode(true);
+    cpu.P.C = 1;
+
+    // the carry set from outside feeds ADC, the pushed and returned status carry what the core computed
+    create_IMM(oc::LDA_IMM, 0x7F);
+    create_IMM(oc::ADC_IMM, 0x00);
+    bus.write(counter++, oc::PHP_IMP);
+    create_IMM(oc::CMP_IMM, 0x80);
+    bus.write(counter++, oc::JMP_ABS);
+    bus.write(counter++, 0x00);
+    bus.write(counter++, 0x03);
+    cpu.run(0x0300);
+
+    EXPECT_EQ(cpu.A, 0x80);
+    EXPECT_EQ(bus.read(0x01FF), 0b11110000);
+    EXPECT_EQ(cpu.P.N, 0);
+    EXPECT_EQ(cpu.P.V, 1);
+    EXPECT_EQ(cpu.P.Z, 1);
+    EXPECT_EQ(cpu.P.C, 1);
+}
+
+TEST_F(cpu6502_test, undocumented_cycles_match_across_modes)
+{
+    for (uint8_t opcode : { 0xEB, 0xFA, 0x02, 0x03, 0x80, 0x04, 0x14, 0x0C, 0x1C }) {
+        std::array<size_t, 2> cycles {};
+        for (auto mode : { cpu6502::execution_mode::cycle_accurate, cpu6502::execution_mode::instruction_accurate }) {
+            SetUp();
+            cpu.mode = mode;
+            bus.write(counter, opcode);
+            cpu.execute();
+            cycles[static_cast<size_t>(mode)] = clock.get_cycles();
+        }
+        EXPECT_EQ(cycles[0], cycles[1]) << std::format("{:#04x}", opcode);
+    }
+}
+
+TEST_F(cpu6502_test, undocumented_NOPs_skip_their_operand)
+{
+    struct nop {
+        uint8_t opcode;
+        uint8_t length;
+        size_t cycles;
+    };
+
+    // only the KIL opcodes jam, the rest of the NOP family reads its operand and moves on
+    const std::array<nop, 6> nops { { { 0x1A, 1, 2 }, { 0x80, 2, 2 }, { 0x04, 2, 3 }, { 0x14, 2, 4 }, { 0x0C, 3, 4 }, { 0x1C, 3, 4 } } };
+    for (const nop& n : nops) {
+        for (auto mode : { cpu6502::execution_mode::cycle_accurate, cpu6502::execution_mode::instruction_accurate }) {
+            SetUp();
+            cpu.mode = mode;
+            cpu.X = 0x01;
+            bus.write(counter, n.opcode);
+            bus.write(counter + 1, 0x10);
+            bus.write(counter + 2, 0x02);
+            cpu.execute();
+
+            EXPECT_EQ(cpu.PC, counter + n.length) << std::format("{:#04x}", n.opcode);
+            EXPECT_EQ(clock.get_cycles(), n.cycles) << std::format("{:#04x}", n.opcode);
+            EXPECT_FALSE(cpu.is_halted());
+        }
+    }
+
+    // absolute, X pays for a page crossing like a load
+    SetUp();
+    cpu.X = 0xFF;
+    bus.write(counter, 0x1C);
+    bus.write(counter + 1, 0x10);
+    bus.write(counter + 2, 0x02);
+    cpu.execute();
+    EXPECT_EQ(clock.get_cycles(), 5);
+}
+
+TEST_F(cpu6502_test, run_stops_on_trap)
+{
+    create_IMM(oc::LDX_IMM, 0x03);
+    bus.write(counter++, oc::DEX_IMP);
+    create_IMM(oc::BNE____, 0xFD);
+    create_IMM(oc::BEQ____, 0xFE);
+    const auto result = cpu.run({ .address = 0x0300, .trap = true });
+
+    EXPECT_EQ(result.reason, cpu6502::stop_reason::trap);
+    EXPECT_EQ(result.pc, 0x0205);
+    EXPECT_EQ(cpu.X, 0x00);
+}
+
+TEST_F(cpu6502_test, block_mode_run_stops_on_trap)
+{
+    cpu.mode = cpu6502::execution_mode::instruction_accurate;
+    cpu.enable_block_mode(true);
+
+    bus.write(counter++, oc::INX_IMP);
+    bus.write(counter++, oc::JMP_ABS);
+    bus.write(counter++, 0x01);
+    bus.write(counter++, 0x02);
+    const auto result = cpu.run({ .address = 0x0300, .trap = true });
+
+    EXPECT_EQ(result.reason, cpu6502::stop_reason::trap);
+    EXPECT_EQ(result.pc, 0x0201);
+    EXPECT_EQ(cpu.X, 0x01);
+    EXPECT_EQ(result.cycles, 2 + 3);
+}
+
+TEST_F(cpu6502_test, run_stops_on_brk)
+{
+    for (bool blocks : { false, true }) {
+        SetUp();
+        cpu.mode = cpu6502::execution_mode::instruction_accurate;
+        cpu.enable_block_mode(blocks);
+
+        bus.write(0xFFFE, 0x00);
+        bus.write(0xFFFF, 0x03);
+        create_IMM(oc::LDA_IMM, 0x01);
+        bus.write(counter++, oc::BRK____);
+        const auto result = cpu.run({ .address = 0x0400, .brk = true });
+
+        EXPECT_EQ(result.reason, cpu6502::stop_reason::brk);
+        EXPECT_EQ(result.pc, 0x0202);
+        EXPECT_EQ(cpu.PC, 0x0300);
+        EXPECT_EQ(result.cycles, 2 + 7);
+    }
+}
+
+TEST_F(cpu6502_test, run_budgets)
+{
+    cpu.mode = cpu6502::execution_mode::instruction_accurate;
+    bus.write(counter++, oc::INX_IMP);
+    bus.write(counter++, oc::JMP_ABS);
+    bus.write(counter++, 0x00);
+    bus.write(counter++, 0x02);
+
+    auto result = cpu.run({ .address = 0x0300, .instructions = 7 });
+    EXPECT_EQ(result.reason, cpu6502::stop_reason::instructions);
+    EXPECT_EQ(cpu.X, 0x04);
+    EXPECT_EQ(result.cycles, 4 * 2 + 3 * 3);
+
+    // blocks stop short of the budget and the rest goes one instruction at a time
+    for (bool blocks : { false, true }) {
+        cpu.enable_block_mode(blocks);
+        cpu.X = 0;
+        cpu.PC = 0x0200;
+        result = cpu.run({ .address = 0x0300, .cycles = 100 });
+        EXPECT_EQ(result.reason, cpu6502::stop_reason::cycles);
+        EXPECT_EQ(result.pc, 0x0200);
+        EXPECT_EQ(result.cycles, 100);
+        EXPECT_EQ(cpu.X, 20);
+    }
+}
+
+TEST_F(cpu6502_test, JAM)
+{
+    for (bool blocks : { false, true }) {
+        SetUp();
+        cpu.mode = cpu6502::execution_mode::instruction_accurate;
+        cpu.enable_block_mode(blocks);
+
+        // PC stays put like on a trap, but the halt is what gets reported
+        bus.write(counter++, oc::INX_IMP);
+        bus.write(counter++, oc::_0x02__);
+        bus.write(counter++, oc::INX_IMP);
+        const auto result = cpu.run({ .address = 0x0300, .trap = true });
+
+        EXPECT_EQ(result.reason, cpu6502::stop_reason::jam);
+        EXPECT_EQ(result.pc, 0x0201);
+        EXPECT_TRUE(cpu.is_halted());
+
+        // neither execute nor an interrupt gets it going again
+        cpu.interrupts.set_nmi(true);
+        cpu.execute();
+        EXPECT_EQ(cpu.run(0x0300).reason, cpu6502::stop_reason::jam);
+        EXPECT_EQ(cpu.PC, 0x0201);
+        EXPECT_EQ(cpu.X, 0x01);
+
+        cpu.reset();
+        EXPECT_FALSE(cpu.is_halted());
+        cpu.interrupts.set_nmi(false);
+    }
+}
+
+TEST_F(cpu6502_test, save_and_restore)
+{
+    cpu.mode = cpu6502::execution_mode::instruction_accurate;
+    cpu.enable_block_mode(true);
+
+    // the first pass turns the NOP into a second INX
+    bus.write(counter++, oc::INX_IMP);
+    bus.write(counter++, oc::NOP_IMP);
+    create_IMM(oc::LDA_IMM, oc::INX_IMP);
+    bus.write(counter++, oc::STA_ABS);
+    bus.write(counter++, 0x01);
+    bus.write(counter++, 0x02);
+    bus.write(counter++, oc::DEY_IMP);
+    create_IMM(oc::BNE____, 0xF6);
+    bus.write(counter++, oc::JMP_ABS);
+    bus.write(counter++, 0x00);
+    bus.write(counter++, 0x03);
+
+    cpu.Y = 3;
+    const cpu6502::cpu_state state = cpu.save();
+    auto image = std::make_unique<memory_image>();
+    bus.snapshot(*image);
+
+    cpu.run(0x0300);
+    const size_t cycles = clock.get_cycles();
+    EXPECT_EQ(cpu.X, 5);
+
+    // the restored NOP is decoded again
+    cpu6502::cpu_state copy;
+    std::memcpy(&copy, &state, sizeof(copy));
+    cpu.restore(copy);
+    bus.restore(*image);
+    EXPECT_EQ(cpu.X, 0);
+    EXPECT_EQ(clock.get_cycles(), 0);
+
+    cpu.run(0x0300);
+    EXPECT_EQ(cpu.X, 5);
+    EXPECT_EQ(clock.get_cycles(), cycles);
+}
+
+TEST_F(cpu6502_test, run_stops_on_breakpoint)
+{
+    // the second INX sits inside a block, enough passes for the jit to translate it
+    for (tier mode : tiers) {
+        SetUp();
+        create_IMM(oc::LDX_IMM, 0x00);
+        bus.write(counter++, oc::INX_IMP);
+        bus.write(counter++, oc::INX_IMP);
+        create_IMM(oc::CPX_IMM, 0x60);
+        create_IMM(oc::BNE____, 0xFA);
+        bus.write(counter++, oc::JMP_ABS);
+        bus.write(counter++, 0x00);
+        bus.write(counter++, 0x03);
+
+        cpu.mode = cpu6502::execution_mode::instruction_accurate;
+        if (!set_tier(cpu, mode))
+            continue;
+
+        cpu.set_breakpoint(break_kind::execute, 0x0203);
+        auto result = cpu.run(0x0300);
+        EXPECT_EQ(result.reason, cpu6502::stop_reason::breakpoint);
+        EXPECT_EQ(result.pc, 0x0203);
+        EXPECT_EQ(result.cycles, 2 + 2);
+        EXPECT_EQ(cpu.X, 0x01);
+
+        // it runs the instruction it stopped on, then stops on it again
+        result = cpu.run(0x0300);
+        EXPECT_EQ(result.reason, cpu6502::stop_reason::breakpoint);
+        EXPECT_EQ(cpu.X, 0x03);
+
+        // the condition is only asked on a hit
+        size_t asked {};
+        cpu.set_breakpoint(break_kind::execute, 0x0203, [&] { asked++; return cpu.X == 0x41; });
+        result = cpu.run(0x0300);
+        EXPECT_EQ(result.reason, cpu6502::stop_reason::breakpoint);
+        EXPECT_EQ(cpu.X, 0x41);
+        EXPECT_EQ(asked, 31);
+
+        cpu.clear_breakpoint(break_kind::execute, 0x0203);
+        result = cpu.run(0x0300);
+        EXPECT_EQ(result.reason, cpu6502::stop_reason::address);
+        EXPECT_EQ(cpu.X, 0x60);
+        EXPECT_EQ(asked, 31);
+    }
+}
+
+TEST_F(cpu6502_test, run_stops_on_watchpoint)
+{
+    for (tier mode : tiers) {
+        SetUp();
+        uint8_t low = 0x10;
+        for (oc opcode : { oc::LDA_ABS, oc::STA_ABS, oc::INC_ABS }) {
+            bus.write(counter++, opcode);
+            bus.write(counter++, low++);
+            bus.write(counter++, 0x03);
+        }
+        bus.write(counter++, oc::JMP_ABS);
+        bus.write(counter++, 0x00);
+        bus.write(counter++, 0x03);
+        bus.write(0x0310, 0x42);
+
+        cpu.mode = cpu6502::execution_mode::instruction_accurate;
+        if (!set_tier(cpu, mode))
+            continue;
+
+        // the store to the same page goes through
+        cpu.set_breakpoint(break_kind::read, 0x0310);
+        cpu.set_breakpoint(break_kind::write, 0x0312);
+        auto result = cpu.run(0x0300);
+        EXPECT_EQ(result.reason, cpu6502::stop_reason::read_watch);
+        EXPECT_EQ(result.pc, 0x0200);
+        EXPECT_EQ(cpu.PC, 0x0203);
+        EXPECT_EQ(cpu.A, 0x42);
+
+        result = cpu.run(0x0300);
+        EXPECT_EQ(result.reason, cpu6502::stop_reason::write_watch);
+        EXPECT_EQ(result.pc, 0x0206);
+        EXPECT_EQ(cpu.PC, 0x0209);
+        EXPECT_EQ(bus.read(0x0311), 0x42);
+        EXPECT_EQ(bus.read(0x0312), 0x01);
+
+        EXPECT_EQ(cpu.run(0x0300).reason, cpu6502::stop_reason::address);
+        cpu.clear_breakpoints();
+    }
+}
+
+TEST_F(cpu6502_test, breakpoint_condition_sees_flags)
+{
+    for (bool blocks : { false, true }) {
+        SetUp();
+        cpu.mode = cpu6502::execution_mode::instruction_accurate;
+        cpu.enable_block_mode(blocks);
+        create_IMM(oc::LDA_IMM, 0x00);
+        bus.write(counter++, oc::NOP_IMP);
+        bus.write(counter++, oc::NOP_IMP);
+
+        cpu.set_breakpoint(break_kind::execute, 0x0203, [&] { return cpu.P.Z == 1; });
+        const auto result = cpu.run({ .address = 0x0300, .cycles = 100 });
+        EXPECT_EQ(result.reason, cpu6502::stop_reason::breakpoint);
+        EXPECT_EQ(result.pc, 0x0203);
+        cpu.clear_breakpoints();
+    }
+}
+
+TEST_F(cpu6502_test, breakpoint_in_idle_loop)
+{
+    create_IMM(oc::LDA_ZPG, 0x10);
+    create_IMM(oc::BEQ____, 0xFC);
+
+    // idle loops are only skipped on a RAM bus
+    for (bool blocks : { false, true }) {
+        clock.reset();
+        basic_cpu6502<memory64k, emulator::clock> ram_cpu { clock, bus };
+        ram_cpu.PC = 0x0200;
+        ram_cpu.mode = cpu6502::execution_mode::instruction_accurate;
+        ram_cpu.enable_block_mode(blocks);
+
+        // the first pass already leaves everything as it was, yet isn't skipped to the end of the budget
+        ram_cpu.P.Z = 1;
+        ram_cpu.set_breakpoint(break_kind::execute, 0x0200);
+        const auto result = ram_cpu.run({ .address = 0x0300, .cycles = 100000 });
+        EXPECT_EQ(result.reason, cpu6502::stop_reason::breakpoint);
+        EXPECT_EQ(result.cycles, 3 + 3);
+        EXPECT_EQ(ram_cpu.get_idle_cycles(), 0u);
+    }
+}
+
 TEST_F(cpu6502_test, RUN)
 {
     bus.load_file("C:/Users/rafal/Source/cpu6502/docs/6502_65C02_functional_tests-master/6502_functional_test.bin");
     clock.set_timing(0);
     cpu.PC = 0x0400;
-    cpu.run(0x3699);
+    const auto result = cpu.run({ .address = 0x3699, .trap = true });
+    EXPECT_EQ(result.reason, cpu6502::stop_reason::address) << std::format("trapped at {:#06x}", result.pc);
 }
 
 }
\ No newline at end of file
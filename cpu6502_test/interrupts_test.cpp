@@ -0,0 +1,265 @@
+#include "machine.h"
+
+namespace emulator {
+
+namespace {
+
+    using oc = cpu6502::opcode;
+
+    struct interrupt_machine : machine {
+        explicit interrupt_machine(const std::vector<uint8_t>& program)
+        {
+            cpu.reset();
+            load(program, 0x0200);
+
+            // both handlers park in a loop of their own
+            bus.write(0xFFFE, 0x00);
+            bus.write(0xFFFF, 0x03);
+            bus.write(0xFFFA, 0x80);
+            bus.write(0xFFFB, 0x03);
+            bus.write(0x0300, oc::JMP_ABS);
+            bus.write(0x0301, 0x00);
+            bus.write(0x0302, 0x03);
+            bus.write(0x0380, oc::JMP_ABS);
+            bus.write(0x0381, 0x80);
+            bus.write(0x0382, 0x03);
+        }
+
+        uint8_t pushed_status() { return bus.read(stack_top() + 1); }
+        uint16_t pushed_pc() { return bus.read(stack_top() + 2) | (bus.read(stack_top() + 3) << 8); }
+        uint16_t stack_top() { return 0x0100 + cpu.S; }
+    };
+
+    // asserts IRQ on any write, a read acknowledges it
+    struct irq_source final : i_device {
+        explicit irq_source(interrupt_lines& lines)
+            : lines(lines)
+        {
+        }
+
+        uint8_t read(uint16_t) override
+        {
+            lines.set_irq(1, false);
+            return 0;
+        }
+        void write(uint16_t, uint8_t) override { lines.set_irq(1, true); }
+
+        interrupt_lines& lines;
+    };
+
+    // the feedback port of the interrupt test assembled with I_drive = 0, a set bit drives the line
+    struct feedback_port final : i_device {
+        explicit feedback_port(interrupt_lines& lines)
+            : lines(lines)
+        {
+        }
+
+        uint8_t read(uint16_t) override { return value; }
+        void write(uint16_t, uint8_t byte) override
+        {
+            value = byte;
+            lines.set_irq(1, byte & (1 << 0));
+            lines.set_nmi(byte & (1 << 1));
+        }
+
+        interrupt_lines& lines;
+        uint8_t value {};
+    };
+
+}
+
+TEST(interrupts, irq_waits_one_instruction_after_cli)
+{
+    interrupt_machine m({ oc::CLI_IMP, oc::INY_IMP, oc::INY_IMP });
+    m.cpu.P.I = 1;
+    m.cpu.interrupts.set_irq(1, true);
+
+    m.cpu.execute();
+    m.cpu.execute();
+    EXPECT_EQ(m.cpu.Y, 1);
+    EXPECT_EQ(m.cpu.PC, 0x0202);
+
+    m.cpu.execute();
+    EXPECT_EQ(m.cpu.Y, 1);
+    EXPECT_EQ(m.cpu.PC, 0x0300);
+    EXPECT_EQ(m.cpu.P.I, 1);
+    EXPECT_EQ(m.pushed_pc(), 0x0202);
+    EXPECT_EQ(m.pushed_status(), 0b00100000);
+    EXPECT_EQ(m.clock.get_cycles(), 2 + 2 + 7);
+}
+
+TEST(interrupts, irq_still_taken_right_after_sei)
+{
+    interrupt_machine m({ oc::SEI_IMP, oc::INY_IMP });
+
+    m.cpu.execute();
+    m.cpu.interrupts.set_irq(1, true);
+    m.cpu.execute();
+
+    EXPECT_EQ(m.cpu.Y, 0);
+    EXPECT_EQ(m.cpu.PC, 0x0300);
+    EXPECT_EQ(m.pushed_pc(), 0x0201);
+    EXPECT_EQ(m.pushed_status(), 0b00100100);
+}
+
+TEST(interrupts, masked_irq_waits_for_the_line)
+{
+    interrupt_machine m({ oc::INY_IMP, oc::INY_IMP, oc::CLI_IMP, oc::NOP_IMP, oc::NOP_IMP });
+    m.cpu.P.I = 1;
+    m.cpu.interrupts.set_irq(1, true);
+    m.cpu.execute();
+    m.cpu.execute();
+    EXPECT_EQ(m.cpu.Y, 2);
+
+    m.cpu.interrupts.set_irq(1, false);
+    m.cpu.execute();
+    m.cpu.execute();
+    m.cpu.execute();
+    EXPECT_EQ(m.cpu.PC, 0x0205);
+}
+
+TEST(interrupts, nmi_on_the_edge_only)
+{
+    interrupt_machine m({ oc::NOP_IMP });
+    m.cpu.P.I = 1;
+    m.cpu.interrupts.set_nmi(true);
+
+    m.cpu.execute();
+    EXPECT_EQ(m.cpu.PC, 0x0380);
+    EXPECT_EQ(m.pushed_pc(), 0x0200);
+
+    // still asserted, the handler's loop keeps running
+    m.cpu.execute();
+    m.cpu.execute();
+    EXPECT_EQ(m.cpu.PC, 0x0380);
+    EXPECT_EQ(m.cpu.S, 0xFC);
+
+    m.cpu.interrupts.set_nmi(false);
+    m.cpu.interrupts.set_nmi(true);
+    m.cpu.execute();
+    EXPECT_EQ(m.cpu.S, 0xF9);
+}
+
+TEST(interrupts, nmi_takes_over_brk)
+{
+    // the page holding the BRK raises NMI as its opcode is fetched
+    struct nmi_on_fetch final : i_device {
+        explicit nmi_on_fetch(interrupt_lines& lines)
+            : lines(lines)
+        {
+        }
+
+        uint8_t read(uint16_t) override
+        {
+            lines.set_nmi(true);
+            return oc::BRK____;
+        }
+        void write(uint16_t, uint8_t) override { }
+
+        interrupt_lines& lines;
+    };
+
+    emulator::clock clock;
+    paged_bus bus;
+    basic_cpu6502<paged_bus, emulator::clock> cpu { clock, bus };
+    nmi_on_fetch device { cpu.interrupts };
+
+    bus.load(0xFFFA, { 0x80, 0x03, 0x00, 0x00, 0x00, 0x03 });
+    bus.map_device(0x20, 1, device);
+    cpu.reset();
+    cpu.PC = 0x2000;
+    cpu.mode = cpu6502::execution_mode::instruction_accurate;
+    cpu.execute();
+
+    EXPECT_EQ(cpu.PC, 0x0380);
+    EXPECT_EQ(bus.read(0x01FF), 0x20);
+    EXPECT_EQ(bus.read(0x01FE), 0x02);
+    EXPECT_EQ(bus.read(0x01FD), 0b00110000);
+    EXPECT_EQ(cpu.interrupts.pending, 0);
+}
+
+TEST(interrupts, device_irq_in_every_execution_mode)
+{
+    // the main loop raises IRQ through the device 200 times, the handler acknowledges and counts
+    const std::vector<uint8_t> program {
+        0x58, // 0400 CLI
+        0xA2, 0xC8, // 0401 LDX #200
+        0x8D, 0x00, 0xD0, // 0403 STA $D000
+        0xC8, // 0406 INY
+        0xCA, // 0407 DEX
+        0xD0, 0xF9, // 0408 BNE $0403
+        0x4C, 0x0A, 0x04, // 040A JMP $040A
+        0x00, 0x00, 0x00,
+        0xAD, 0x00, 0xD0, // 0410 LDA $D000
+        0xE6, 0x10, // 0413 INC $10
+        0xD0, 0x02, // 0415 BNE $0419
+        0xE6, 0x11, // 0417 INC $11
+        0x40, // 0419 RTI
+    };
+
+    struct run : basic_machine<paged_bus> {
+        using basic_machine::basic_machine;
+        irq_source device { cpu.interrupts };
+    };
+
+    std::vector<std::unique_ptr<run>> runs;
+    for (tier mode : tiers) {
+        auto& r = *runs.emplace_back(std::make_unique<run>(mode));
+        r.bus.load(0x0400, program);
+        r.bus.load(0xFFFE, { 0x10, 0x04 });
+        r.bus.map_device(0xD0, 1, r.device);
+        r.cpu.reset();
+        r.cpu.PC = 0x0400;
+        r.cpu.P.I = 1;
+        r.cpu.run(0x040A);
+    }
+
+    for (auto& r : runs) {
+        EXPECT_EQ(r->bus.read(0x0010), 200);
+        EXPECT_EQ(r->bus.read(0x0011), 0);
+        EXPECT_EQ(r->cpu.Y, 200);
+        EXPECT_EQ(r->cpu.S, 0xFF);
+        EXPECT_EQ(r->clock.get_cycles(), runs[0]->clock.get_cycles());
+    }
+}
+
+TEST(interrupts, RUN)
+{
+    const std::string folder = "C:/Users/rafal/Source/cpu6502/docs/6502_65C02_functional_tests-master/";
+    std::ifstream listing(folder + "6502_interrupt_test.lst");
+    if (!listing.is_open())
+        GTEST_SKIP() << "6502_interrupt_test not found";
+
+    // the success trap is the jmp * after "if you get here everything went well"
+    uint16_t success {};
+    for (std::string line; std::getline(listing, line);) {
+        if (line.find("everything went well") != std::string::npos) {
+            std::getline(listing, line);
+            success = static_cast<uint16_t>(std::stoi(line, nullptr, 16));
+            break;
+        }
+    }
+    ASSERT_NE(success, 0);
+
+    emulator::clock clock;
+    paged_bus bus;
+    basic_cpu6502<paged_bus, emulator::clock> cpu { clock, bus };
+    feedback_port port { cpu.interrupts };
+
+    bus.load_file(folder + "6502_interrupt_test.bin");
+    bus.map_device(0xBF, 1, port);
+    clock.set_timing(0);
+    cpu.mode = cpu6502::execution_mode::instruction_accurate;
+    cpu.PC = 0x0400;
+
+    // every trap is a jmp * or a branch to itself
+    uint16_t last_pc {};
+    while (cpu.PC != last_pc) {
+        last_pc = cpu.PC;
+        cpu.execute();
+    }
+
+    EXPECT_EQ(cpu.PC, success);
+}
+
+}
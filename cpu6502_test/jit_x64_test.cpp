@@ -0,0 +1,83 @@
+#include "machine.h"
+
+namespace emulator {
+
+namespace {
+
+    void run_both(const std::vector<uint8_t>& program, uint16_t stop)
+    {
+        machine jit(program);
+        machine interpreter(program);
+
+        if (!jit.cpu.enable_jit(true))
+            GTEST_SKIP() << "no x86-64 host";
+
+        jit.cpu.run(stop);
+        interpreter.cpu.run(stop);
+        expect_same(jit, interpreter);
+    }
+
+    // page crossing loads and stores, ALU ops, shifts, the stack and a JSR the jit leaves to the interpreter
+    const std::vector<uint8_t> mixed_loop {
+        0xA9, 0x05, // 0400 LDA #5
+        0x85, 0x30, // 0402 STA $30
+        0xA2, 0x00, // 0404 LDX #0
+        0xBD, 0xF0, 0x10, // 0406 LDA $10F0,X
+        0x18, // 0409 CLC
+        0x69, 0x03, // 040A ADC #3
+        0x9D, 0xF0, 0x10, // 040C STA $10F0,X
+        0x45, 0x20, // 040F EOR $20
+        0x85, 0x20, // 0411 STA $20
+        0x0A, // 0413 ASL A
+        0x26, 0x21, // 0414 ROL $21
+        0x48, // 0416 PHA
+        0x68, // 0417 PLA
+        0xE9, 0x01, // 0418 SBC #1
+        0x20, 0x30, 0x04, // 041A JSR $0430
+        0xE8, // 041D INX
+        0xD0, 0xE6, // 041E BNE $0406
+        0xC6, 0x30, // 0420 DEC $30
+        0xD0, 0xE0, // 0422 BNE $0404
+        0x4C, 0x24, 0x04, // 0424 JMP $0424
+        0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA,
+        0x24, 0x21, // 0430 BIT $21
+        0x60, // 0432 RTS
+    };
+
+}
+
+TEST(jit_x64, matches_interpreter)
+{
+    run_both(mixed_loop, 0x0424);
+}
+
+TEST(jit_x64, stops_inside_translated_code)
+{
+    // LDA $10F0,X first lands on $1170 with X = $80, long after the loop got hot
+    run_both(mixed_loop, 0x1170);
+}
+
+TEST(jit_x64, store_into_translated_code)
+{
+    const std::vector<uint8_t> program {
+        0xA2, 0x00, // 0400 LDX #0
+        0xA9, 0x00, // 0402 LDA #0, the operand is patched below
+        0x9D, 0x00, 0x20, // 0404 STA $2000,X
+        0xEE, 0x03, 0x04, // 0407 INC $0403
+        0xE8, // 040A INX
+        0xD0, 0xF5, // 040B BNE $0402
+        0x4C, 0x0D, 0x04, // 040D JMP $040D
+    };
+
+    run_both(program, 0x040D);
+
+    machine jit(program);
+    if (!jit.cpu.enable_jit(true))
+        GTEST_SKIP() << "no x86-64 host";
+    jit.cpu.run(0x040D);
+
+    EXPECT_EQ(jit.bus.read(0x2080), 0x80);
+    EXPECT_EQ(jit.bus.read(0x20FF), 0xFF);
+}
+
+}
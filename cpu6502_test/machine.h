@@ -0,0 +1,84 @@
+#pragma once
+
+#include "../cpu6502/clock.h"
+#include "../cpu6502/cpu6502.h"
+#include "../cpu6502/memory64k.h"
+#include "../cpu6502/paged_bus.h"
+#include "gtest/gtest.h"
+
+namespace emulator {
+
+// how a cpu runs its code
+enum class tier {
+    interpreter,
+    decode_cache,
+    blocks,
+    jit,
+};
+
+constexpr std::array<tier, 4> tiers { tier::interpreter, tier::decode_cache, tier::blocks, tier::jit };
+
+// false when the jit doesn't run on the host or the bus, the cpu is left running blocks then
+template <typename Cpu>
+bool set_tier(Cpu& cpu, tier mode)
+{
+    cpu.enable_decode_cache(mode != tier::interpreter);
+    cpu.enable_block_mode(mode == tier::blocks || mode == tier::jit);
+    return mode != tier::jit || cpu.enable_jit(true);
+}
+
+// a cpu with a clock and a bus of its own for tests running whole programs, instruction accurate
+template <typename Bus>
+struct basic_machine {
+    emulator::clock clock;
+    Bus bus;
+    basic_cpu6502<Bus, emulator::clock> cpu { clock, bus };
+
+    explicit basic_machine(tier mode = tier::interpreter)
+    {
+        cpu.S = 0xFD;
+        cpu.mode = cpu6502::execution_mode::instruction_accurate;
+        set_tier(cpu, mode);
+    }
+
+    explicit basic_machine(const std::vector<uint8_t>& program, tier mode = tier::interpreter, uint16_t origin = 0x0400)
+        : basic_machine(mode)
+    {
+        load(program, origin);
+    }
+
+    // PC goes to the first byte
+    void load(const std::vector<uint8_t>& program, uint16_t origin = 0x0400)
+    {
+        for (size_t i = 0; i < program.size(); i++)
+            bus.write(static_cast<uint16_t>(origin + i), program[i]);
+        cpu.PC = origin;
+    }
+};
+
+using machine = basic_machine<memory64k>;
+
+// the registers, the clock and the bus's memory
+template <typename Bus>
+void expect_same(basic_machine<Bus>& m, basic_machine<Bus>& expected)
+{
+    EXPECT_EQ(m.cpu.A, expected.cpu.A);
+    EXPECT_EQ(m.cpu.X, expected.cpu.X);
+    EXPECT_EQ(m.cpu.Y, expected.cpu.Y);
+    EXPECT_EQ(m.cpu.S, expected.cpu.S);
+    EXPECT_EQ(std::bit_cast<uint8_t>(m.cpu.P), std::bit_cast<uint8_t>(expected.cpu.P));
+    EXPECT_EQ(m.cpu.PC, expected.cpu.PC);
+    EXPECT_EQ(m.cpu.address, expected.cpu.address);
+    EXPECT_EQ(m.clock.get_cycles(), expected.clock.get_cycles());
+
+    auto image = std::make_unique<memory_image>();
+    auto expected_image = std::make_unique<memory_image>();
+    m.bus.snapshot(*image);
+    expected.bus.snapshot(*expected_image);
+    size_t differences = 0;
+    for (size_t address = 0; address < image->size(); address++)
+        differences += (*image)[address] != (*expected_image)[address];
+    EXPECT_EQ(differences, 0);
+}
+
+}
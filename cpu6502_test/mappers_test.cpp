@@ -0,0 +1,131 @@
+#include "../cpu6502/clock.h"
+#include "../cpu6502/cpu6502.h"
+#include "../cpu6502/mappers.h"
+#include "../cpu6502/paged_bus.h"
+#include "gtest/gtest.h"
+
+namespace emulator {
+
+namespace {
+
+    using cpu_t = basic_cpu6502<paged_bus, emulator::clock>;
+
+    // every bank returns its number in A from a routine at $8000, the fixed bank calls banks 2, 1 and 2 again
+    std::vector<uint8_t> make_uxrom_image()
+    {
+        std::vector<uint8_t> rom(4 * uxrom_mapper::bank_size, 0xEA);
+        for (size_t bank = 0; bank < 3; bank++) {
+            const std::vector<uint8_t> routine { 0xA9, static_cast<uint8_t>(bank), 0x60 }; // LDA #bank, RTS
+            std::copy(routine.begin(), routine.end(), rom.begin() + bank * uxrom_mapper::bank_size);
+        }
+
+        const std::vector<uint8_t> driver {
+            0xA9, 0x02, // C000 LDA #2
+            0x8D, 0x00, 0x80, // C002 STA $8000
+            0x20, 0x00, 0x80, // C005 JSR $8000
+            0x85, 0x10, // C008 STA $10
+            0xA9, 0x01, // C00A LDA #1
+            0x8D, 0x00, 0x80, // C00C STA $8000
+            0x20, 0x00, 0x80, // C00F JSR $8000
+            0x85, 0x11, // C012 STA $11
+            0xA9, 0x02, // C014 LDA #2
+            0x8D, 0x00, 0x80, // C016 STA $8000
+            0x20, 0x00, 0x80, // C019 JSR $8000
+            0x85, 0x12, // C01C STA $12
+            0x4C, 0x1E, 0xC0, // C01E JMP $C01E
+        };
+        std::copy(driver.begin(), driver.end(), rom.begin() + 3 * uxrom_mapper::bank_size);
+        return rom;
+    }
+
+    void run_uxrom(void (*setup)(cpu_t&))
+    {
+        emulator::clock clock;
+        paged_bus bus;
+        uxrom_mapper mapper(bus, make_uxrom_image());
+        cpu_t cpu { clock, bus };
+
+        cpu.reset();
+        cpu.PC = 0xC000;
+        cpu.mode = cpu6502::execution_mode::instruction_accurate;
+        setup(cpu);
+        cpu.run(0xC01E);
+
+        EXPECT_EQ(bus.read(0x0010), 0x02);
+        EXPECT_EQ(bus.read(0x0011), 0x01);
+        EXPECT_EQ(bus.read(0x0012), 0x02);
+        EXPECT_EQ(mapper.get_bank(), 2);
+        EXPECT_EQ(mapper.get_switches(), 3);
+    }
+
+}
+
+TEST(mappers, uxrom_switches_code_under_the_interpreter)
+{
+    run_uxrom([](cpu_t&) {});
+}
+
+TEST(mappers, uxrom_switches_code_under_block_mode)
+{
+    run_uxrom([](cpu_t& cpu) { cpu.enable_block_mode(true); });
+}
+
+TEST(mappers, uxrom_image_size)
+{
+    paged_bus bus;
+    EXPECT_THROW(uxrom_mapper(bus, std::vector<uint8_t>(uxrom_mapper::bank_size)), std::invalid_argument);
+    EXPECT_THROW(uxrom_mapper(bus, std::vector<uint8_t>(uxrom_mapper::bank_size * 2 + 1)), std::invalid_argument);
+}
+
+TEST(mappers, banked_ram_register_outside_the_window)
+{
+    paged_bus bus;
+    EXPECT_THROW(banked_ram_mapper(bus, 4, 0xA0), std::invalid_argument);
+    EXPECT_THROW(banked_ram_mapper(bus, 4, 0xBF), std::invalid_argument);
+    EXPECT_NO_THROW(banked_ram_mapper(bus, 4, 0xC0));
+}
+
+TEST(mappers, banked_ram_window)
+{
+    emulator::clock clock;
+    paged_bus bus;
+    banked_ram_mapper mapper(bus, 4);
+    cpu_t cpu { clock, bus };
+
+    // fills the window with the bank number in every bank, then reads bank 1 back
+    const std::vector<uint8_t> program {
+        0xA0, 0x03, // 0400 LDY #3
+        0x8C, 0x00, 0xDF, // 0402 STY $DF00
+        0xA2, 0x00, // 0405 LDX #0
+        0x98, // 0407 TYA
+        0x9D, 0x00, 0xA0, // 0408 STA $A000,X
+        0x9D, 0x00, 0xBF, // 040B STA $BF00,X
+        0xE8, // 040E INX
+        0xD0, 0xF7, // 040F BNE $0408
+        0x88, // 0411 DEY
+        0x10, 0xEE, // 0412 BPL $0402
+        0xA9, 0x01, // 0414 LDA #1
+        0x8D, 0x00, 0xDF, // 0416 STA $DF00
+        0xAD, 0x80, 0xBF, // 0419 LDA $BF80
+        0xAE, 0x00, 0xDF, // 041C LDX $DF00
+        0x4C, 0x1F, 0x04, // 041F JMP $041F
+    };
+    bus.load(0x0400, program);
+
+    cpu.reset();
+    cpu.PC = 0x0400;
+    cpu.mode = cpu6502::execution_mode::instruction_accurate;
+    const bool native = cpu.enable_jit(true);
+    cpu.run(0x041F);
+
+    EXPECT_EQ(cpu.A, 0x01);
+    EXPECT_EQ(cpu.X, 0x01);
+    EXPECT_EQ(mapper.get_switches(), 5);
+    for (uint8_t bank = 0; bank < 4; bank++) {
+        mapper.select(bank);
+        EXPECT_EQ(bus.read(0xA000), bank) << "jit " << native;
+        EXPECT_EQ(bus.read(0xBFFF), bank) << "jit " << native;
+    }
+}
+
+}
@@ -0,0 +1,101 @@
+#include "../cpu6502/clock.h"
+#include "../cpu6502/cpu6502.h"
+#include "../cpu6502/memory64k.h"
+#include "gtest/gtest.h"
+
+namespace emulator {
+
+TEST(memory64k, dirty_pages)
+{
+    memory64k bus;
+    bus.write(0x1234, 1);
+    EXPECT_FALSE(bus.is_dirty(0x12));
+
+    bus.track_dirty_pages(true);
+    bus.write(0x1234, 2);
+    bus.write(0xFF00, 3);
+    EXPECT_TRUE(bus.is_dirty(0x12));
+    EXPECT_TRUE(bus.is_dirty(0xFF));
+    EXPECT_FALSE(bus.is_dirty(0x13));
+    const memory64k::page_set expected { 1ull << 0x12, 0, 0, 1ull << 63 };
+    EXPECT_EQ(bus.get_dirty_pages(), expected);
+
+    const uint32_t marks = bus.get_marks();
+    bus.mark_clean();
+    EXPECT_FALSE(bus.is_dirty(0x12));
+    EXPECT_NE(bus.get_marks(), marks);
+
+    // writing the whole memory dirties every page
+    bus.reset();
+    EXPECT_TRUE(bus.is_dirty(0x00));
+    EXPECT_TRUE(bus.is_dirty(0x80));
+}
+
+TEST(memory64k, reset_to_baseline)
+{
+    memory64k bus;
+    bus.write(0x0010, 0x11);
+    bus.write(0x2000, 0x22);
+    bus.set_baseline();
+    EXPECT_TRUE(bus.is_tracking());
+
+    bus.write(0x0010, 0x33);
+    bus.write(0x2001, 0x44);
+    bus.write(0x9000, 0x55);
+
+    memory64k::page_snapshot snapshot;
+    bus.snapshot_dirty(snapshot);
+    EXPECT_EQ(snapshot.bytes.size(), 3 * 256u);
+
+    bus.reset_to_baseline();
+    EXPECT_EQ(bus.read(0x0010), 0x11);
+    EXPECT_EQ(bus.read(0x2000), 0x22);
+    EXPECT_EQ(bus.read(0x2001), 0x00);
+    EXPECT_EQ(bus.read(0x9000), 0x00);
+    EXPECT_FALSE(bus.is_dirty(0x20));
+
+    // the snapshot goes on top of the baseline, its pages stay dirty
+    bus.write(0x4000, 0x66);
+    bus.restore(snapshot);
+    EXPECT_EQ(bus.read(0x0010), 0x33);
+    EXPECT_EQ(bus.read(0x2000), 0x22);
+    EXPECT_EQ(bus.read(0x2001), 0x44);
+    EXPECT_EQ(bus.read(0x9000), 0x55);
+    EXPECT_EQ(bus.read(0x4000), 0x00);
+    EXPECT_TRUE(bus.is_dirty(0x90));
+    EXPECT_FALSE(bus.is_dirty(0x40));
+}
+
+TEST(memory64k, jit_stores_mark_pages_dirty)
+{
+    // one store per pass, the budget runs out in the delay loop
+    const std::vector<uint8_t> program {
+        0xA2, 0x00, // 0400 LDX #0
+        0xCA, // 0402 DEX
+        0xD0, 0xFD, // 0403 BNE $0402
+        0x8D, 0x00, 0x20, // 0405 STA $2000
+        0x4C, 0x00, 0x04, // 0408 JMP $0400
+    };
+
+    emulator::clock clock;
+    memory64k bus;
+    basic_cpu6502<memory64k, emulator::clock> cpu { clock, bus };
+    for (size_t i = 0; i < program.size(); i++)
+        bus.write(static_cast<uint16_t>(0x0400 + i), program[i]);
+    cpu.PC = 0x0400;
+    cpu.mode = cpu6502::execution_mode::instruction_accurate;
+    if (!cpu.enable_jit(true))
+        GTEST_SKIP() << "no x86-64 host";
+
+    bus.track_dirty_pages(true);
+    cpu.run({ .address = 0xFFFF, .cycles = 100000 });
+    EXPECT_TRUE(bus.is_dirty(0x20));
+
+    // the loop is translated by now, its first store after the mark still reaches the bus
+    bus.mark_clean();
+    cpu.run({ .address = 0xFFFF, .cycles = 20000 });
+    EXPECT_TRUE(bus.is_dirty(0x20));
+    EXPECT_FALSE(bus.is_dirty(0x04));
+}
+
+}
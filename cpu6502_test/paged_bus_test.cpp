@@ -0,0 +1,245 @@
+#include "machine.h"
+
+namespace emulator {
+
+namespace {
+
+    // a latch that counts its accesses
+    struct latch final : i_device {
+        uint8_t read(uint16_t address) override
+        {
+            reads++;
+            last_address = address;
+            return value;
+        }
+        void write(uint16_t address, uint8_t byte) override
+        {
+            writes++;
+            last_address = address;
+            value = byte;
+        }
+
+        uint8_t value {};
+        uint16_t last_address {};
+        size_t reads {};
+        size_t writes {};
+    };
+
+}
+
+TEST(paged_bus, ram_rom_and_device_pages)
+{
+    paged_bus bus;
+    latch device;
+
+    bus.load(0xF000, { 0x11, 0x22 });
+    bus.map_rom(0xF0, 0x10);
+    bus.map_device(0xD0, 1, device);
+
+    bus.write(0x1234, 0x56);
+    bus.write(0xF000, 0x99);
+    bus.write(0xD012, 0x42);
+
+    EXPECT_EQ(bus.read(0x1234), 0x56);
+    EXPECT_EQ(bus.read(0xF000), 0x11);
+    EXPECT_EQ(bus.read(0xF001), 0x22);
+    EXPECT_EQ(bus.read(0xD0FF), 0x42);
+    EXPECT_EQ(device.writes, 1);
+    EXPECT_EQ(device.reads, 1);
+    EXPECT_EQ(device.last_address, 0xD0FF);
+
+    EXPECT_NE(bus.ram_page(0x12), nullptr);
+    EXPECT_EQ(bus.ram_page(0xF0), nullptr);
+    EXPECT_EQ(bus.ram_page(0xD0), nullptr);
+    EXPECT_NE(bus.read_page(0xF0), nullptr);
+    EXPECT_EQ(bus.read_page(0xD0), nullptr);
+
+    bus.reset();
+    EXPECT_EQ(bus.read(0x1234), 0x00);
+    EXPECT_EQ(bus.read(0xF000), 0x11);
+}
+
+TEST(paged_bus, device_needs_pages_above_the_stack)
+{
+    paged_bus bus;
+    latch device;
+
+    EXPECT_THROW(bus.map_device(0x01, 1, device), std::invalid_argument);
+    EXPECT_THROW(bus.map_ram(0xFF, 2), std::out_of_range);
+    EXPECT_FALSE(bus.is_device(0x01));
+}
+
+TEST(paged_bus, cpu_runs_from_rom)
+{
+    emulator::clock clock;
+    paged_bus bus;
+    latch device;
+    basic_cpu6502<paged_bus, emulator::clock> cpu { clock, bus };
+
+    bus.load(0xF000, {
+                         0xA2, 0x03, // F000 LDX #3
+                         0x8E, 0x00, 0xD0, // F002 STX $D000
+                         0x20, 0x10, 0xF0, // F005 JSR $F010
+                         0xCA, // F008 DEX
+                         0xD0, 0xF7, // F009 BNE $F002
+                         0x4C, 0x0B, 0xF0, // F00B JMP $F00B
+                         0xEA, 0xEA,
+                         0xAD, 0x00, 0xD0, // F010 LDA $D000
+                         0x85, 0x10, // F013 STA $10
+                         0x8D, 0x00, 0xF0, // F015 STA $F000
+                         0x60, // F018 RTS
+                     });
+    bus.map_rom(0xF0, 0x10);
+    bus.map_device(0xD0, 1, device);
+
+    cpu.reset();
+    cpu.PC = 0xF000;
+    cpu.mode = cpu6502::execution_mode::instruction_accurate;
+    cpu.enable_block_mode(true);
+    cpu.run(0xF00B);
+
+    EXPECT_EQ(cpu.X, 0x00);
+    EXPECT_EQ(cpu.A, 0x01);
+    EXPECT_EQ(cpu.S, 0xFF);
+    EXPECT_EQ(bus.read(0x0010), 0x01);
+    EXPECT_EQ(bus.read(0xF000), 0xA2);
+    EXPECT_EQ(device.writes, 3);
+    EXPECT_EQ(device.reads, 3);
+}
+
+TEST(paged_bus, decoding_never_reads_a_device_page)
+{
+    for (tier mode : tiers) {
+        emulator::clock clock;
+        paged_bus bus;
+        latch device;
+        basic_cpu6502<paged_bus, emulator::clock> cpu { clock, bus };
+
+        // the loop ends right below the device page
+        bus.load(0xCFFC, {
+                             0xB8, // CFFC CLV
+                             0xE8, // CFFD INX
+                             0x50, 0xFD, // CFFE BVC $CFFD
+                         });
+        bus.map_device(0xD0, 1, device);
+
+        cpu.reset();
+        cpu.PC = 0xCFFC;
+        cpu.mode = cpu6502::execution_mode::instruction_accurate;
+        set_tier(cpu, mode);
+        cpu.run({ .address = 0x0300, .cycles = 50 });
+
+        // six cycles a pass, the branch back crosses a page
+        EXPECT_EQ(cpu.X, 8);
+        EXPECT_EQ(device.reads, 0);
+    }
+}
+
+TEST(paged_bus, block_mode_runs_code_on_a_device_page)
+{
+    emulator::clock clock;
+    paged_bus bus;
+    latch device;
+    basic_cpu6502<paged_bus, emulator::clock> cpu { clock, bus };
+
+    device.value = 0xE8; // INX everywhere
+    bus.map_device(0xD0, 1, device);
+
+    cpu.reset();
+    cpu.PC = 0xD000;
+    cpu.mode = cpu6502::execution_mode::instruction_accurate;
+    cpu.enable_block_mode(true);
+    cpu.run({ .address = 0x0300, .cycles = 20 });
+
+    // the opcode fetch and the dummy read after it
+    EXPECT_EQ(cpu.X, 10);
+    EXPECT_EQ(device.reads, 20);
+}
+
+TEST(paged_bus, devices_see_the_current_status)
+{
+    // remembers the status the cpu reports while it reads the device
+    struct probe final : i_device {
+        uint8_t read(uint16_t) override
+        {
+            seen = cpu->get_status();
+            return 0x00;
+        }
+        void write(uint16_t, uint8_t) override { }
+
+        const basic_cpu6502<paged_bus, emulator::clock>* cpu = nullptr;
+        cpu6502::status seen {};
+    };
+
+    for (tier mode : tiers) {
+        basic_machine<paged_bus> m({
+                                       0xA9, 0x80, // 0400 LDA #$80
+                                       0xAD, 0x00, 0xD0, // 0402 LDA $D000
+                                       0x4C, 0x05, 0x04, // 0405 JMP $0405
+                                   },
+            mode);
+        probe device;
+        device.cpu = &m.cpu;
+        m.bus.map_device(0xD0, 1, device);
+        m.cpu.run(0x0405);
+
+        // the flags of LDA #$80, P only gets them when run returns
+        EXPECT_TRUE(device.seen.N);
+        EXPECT_FALSE(device.seen.Z);
+        EXPECT_FALSE(m.cpu.P.N);
+        EXPECT_TRUE(m.cpu.P.Z);
+        EXPECT_EQ(std::bit_cast<uint8_t>(m.cpu.get_status()), std::bit_cast<uint8_t>(m.cpu.P));
+    }
+}
+
+TEST(paged_bus, jit_leaves_device_and_rom_pages_to_the_interpreter)
+{
+    emulator::clock jit_clock;
+    emulator::clock interpreter_clock;
+    paged_bus jit_bus;
+    paged_bus interpreter_bus;
+    latch jit_device;
+    latch interpreter_device;
+    basic_cpu6502<paged_bus, emulator::clock> jit { jit_clock, jit_bus };
+    basic_cpu6502<paged_bus, emulator::clock> interpreter { interpreter_clock, interpreter_bus };
+
+    const std::vector<uint8_t> program {
+        0xA2, 0x00, // 0400 LDX #0
+        0x8E, 0x00, 0xD0, // 0402 STX $D000
+        0xAD, 0x00, 0xD0, // 0405 LDA $D000
+        0x9D, 0x00, 0x20, // 0408 STA $2000,X
+        0x9D, 0x00, 0xF0, // 040B STA $F000,X
+        0xE8, // 040E INX
+        0xD0, 0xF1, // 040F BNE $0402
+        0x4C, 0x11, 0x04, // 0411 JMP $0411
+    };
+
+    for (auto* bus : { &jit_bus, &interpreter_bus }) {
+        bus->load(0x0400, program);
+        bus->map_rom(0xF0, 0x10);
+    }
+    jit_bus.map_device(0xD0, 1, jit_device);
+    interpreter_bus.map_device(0xD0, 1, interpreter_device);
+
+    for (auto* cpu : { &jit, &interpreter }) {
+        cpu->reset();
+        cpu->PC = 0x0400;
+        cpu->mode = cpu6502::execution_mode::instruction_accurate;
+    }
+
+    if (!jit.enable_jit(true))
+        GTEST_SKIP() << "no x86-64 host";
+
+    jit.run(0x0411);
+    interpreter.run(0x0411);
+
+    EXPECT_EQ(jit.X, interpreter.X);
+    EXPECT_EQ(jit.PC, interpreter.PC);
+    EXPECT_EQ(jit_clock.get_cycles(), interpreter_clock.get_cycles());
+    EXPECT_EQ(jit_device.writes, 256);
+    EXPECT_EQ(jit_device.reads, 256);
+    EXPECT_EQ(jit_bus.read(0x20FF), 0xFF);
+    EXPECT_EQ(jit_bus.read(0xF0FF), 0x00);
+}
+
+}
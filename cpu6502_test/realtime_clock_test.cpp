@@ -0,0 +1,62 @@
+#include "../cpu6502/realtime_clock.h"
+#include "gtest/gtest.h"
+
+namespace emulator {
+
+TEST(realtime_clock, paces_to_frequency)
+{
+    realtime_clock clock;
+    clock.set_frequency(1'000'000.0);
+    clock.set_timing(1'000);
+    clock.reset();
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < 50'000; i++)
+        clock.cycle();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(clock.get_cycles(), 50'000);
+    EXPECT_GE(elapsed, std::chrono::milliseconds(49));
+}
+
+TEST(realtime_clock, add_cycles_paces_like_single_cycles)
+{
+    realtime_clock clock;
+    clock.set_frequency(1'000'000.0);
+    clock.reset();
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < 10'000; i++)
+        clock.add_cycles(5);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(clock.get_cycles(), 50'000);
+    EXPECT_GE(elapsed, std::chrono::milliseconds(49));
+}
+
+TEST(realtime_clock, first_slice_is_paced)
+{
+    // no setter or reset, the constructor has to set the reference
+    realtime_clock clock;
+
+    auto start = std::chrono::steady_clock::now();
+    clock.add_cycles(20'455);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_GE(elapsed, std::chrono::milliseconds(19));
+}
+
+TEST(realtime_clock, warp_is_unthrottled)
+{
+    realtime_clock clock;
+    clock.set_frequency(1.0);
+    clock.set_warp(true);
+    clock.reset();
+
+    for (size_t i = 0; i < 1'000'000; i++)
+        clock.cycle();
+
+    EXPECT_EQ(clock.get_cycles(), 1'000'000);
+}
+
+}
@@ -0,0 +1,122 @@
+#include "machine.h"
+#include "../cpu6502/replay.h"
+#include "../cpu6502/via6522.h"
+
+namespace emulator {
+
+namespace {
+
+    // T1 free-runs at 1000 cycles, the handler samples T1 and counts 64 interrupts while the main loop spins,
+    // reading T1CL drops the IRQ within the access, the underflow event raises it between two instructions
+    const std::vector<uint8_t> program {
+        0xA9, 0xE6, // 0400 LDA #<998
+        0x8D, 0x04, 0xD0, // 0402 STA T1CL
+        0xA9, 0x03, // 0405 LDA #>998
+        0x8D, 0x05, 0xD0, // 0407 STA T1CH
+        0xA9, 0x40, // 040A LDA #$40
+        0x8D, 0x0B, 0xD0, // 040C STA ACR
+        0xA9, 0xC0, // 040F LDA #$C0
+        0x8D, 0x0E, 0xD0, // 0411 STA IER
+        0x58, // 0414 CLI
+        0xA5, 0x10, // 0415 LDA $10
+        0xC9, 0x40, // 0417 CMP #64
+        0xD0, 0xFA, // 0419 BNE $0415
+        0x4C, 0x1B, 0x04, // 041B JMP $041B
+        0x00, 0x00,
+        0xAD, 0x04, 0xD0, // 0420 LDA T1CL
+        0xA6, 0x10, // 0423 LDX $10
+        0x9D, 0x00, 0x03, // 0425 STA $0300,X
+        0xE6, 0x10, // 0428 INC $10
+        0x40, // 042A RTI
+    };
+    constexpr uint16_t stop = 0x041B;
+
+    struct recording {
+        cpu6502::cpu_state start;
+        std::unique_ptr<memory_image> memory = std::make_unique<memory_image>();
+        std::vector<uint8_t> log;
+        uint64_t hash {};
+    };
+
+    recording record(tier mode)
+    {
+        basic_machine<paged_bus> m { mode };
+        scheduler events;
+        via6522 via { [&m] { return m.cpu.get_cycles(); }, events, m.cpu.interrupts };
+        input_recorder recorder { m.cpu.interrupts, [&m] { return m.cpu.get_cycles(); } };
+
+        m.bus.load(0x0400, program);
+        m.bus.load(0xFFFE, { 0x20, 0x04 });
+        m.bus.map_device(0xD0, 1, recorder.tap(via));
+        m.cpu.reset();
+        m.cpu.PC = 0x0400;
+        m.cpu.P.I = 1;
+
+        recording result;
+        result.start = m.cpu.save();
+        m.bus.snapshot(*result.memory);
+        events.run(m.cpu, stop);
+        EXPECT_EQ(m.bus.read(0x0010), 64);
+
+        result.log = recorder.get_log();
+        result.hash = state_hash(m.cpu, m.bus);
+        return result;
+    }
+
+}
+
+TEST(replay, matches_the_recorded_run)
+{
+    for (tier mode : tiers) {
+        const recording recorded = record(mode);
+
+        // a read and an IRQ change per interrupt, a few bytes each
+        EXPECT_LT(recorded.log.size(), 64 * 12u);
+
+        basic_machine<paged_bus> m { mode };
+        m.bus.restore(*recorded.memory);
+        m.cpu.restore(recorded.start);
+        input_player player { recorded.log, m.cpu.interrupts, [&m] { return m.cpu.get_cycles(); } };
+        m.bus.map_device(0xD0, 1, player);
+
+        const auto result = player.run(m.cpu, stop);
+        EXPECT_EQ(result.reason, cpu6502::stop_reason::address);
+        EXPECT_TRUE(player.is_done());
+        EXPECT_EQ(m.bus.read(0x0010), 64);
+        EXPECT_EQ(state_hash(m.cpu, m.bus), recorded.hash) << "tier " << static_cast<int>(mode);
+    }
+}
+
+TEST(replay, stops_when_out_of_sync)
+{
+    const recording recorded = record(tier::interpreter);
+
+    // the handler takes two cycles longer, its T1 read comes late
+    basic_machine<paged_bus> m;
+    m.bus.restore(*recorded.memory);
+    m.bus.write(0xFFFE, 0x1E);
+    m.bus.write(0x041E, 0xEA);
+    m.bus.write(0x041F, 0xEA);
+    m.cpu.restore(recorded.start);
+    input_player player { recorded.log, m.cpu.interrupts, [&m] { return m.cpu.get_cycles(); } };
+    m.bus.map_device(0xD0, 1, player);
+
+    const auto result = player.run(m.cpu, stop);
+    EXPECT_EQ(result.reason, cpu6502::stop_reason::deadline);
+    EXPECT_TRUE(player.is_desynced());
+    EXPECT_FALSE(player.is_done());
+    EXPECT_NE(m.cpu.PC, stop);
+}
+
+TEST(replay, throws_on_a_broken_log)
+{
+    emulator::clock clock;
+    interrupt_lines lines;
+    auto cycles = [&clock] { return clock.get_cycles(); };
+
+    EXPECT_THROW((input_player { { 0x00 }, lines, cycles }), std::runtime_error); // a read without its byte
+    EXPECT_THROW((input_player { { 0x03 }, lines, cycles }), std::runtime_error); // no such entry
+    EXPECT_THROW((input_player { { 0x80 }, lines, cycles }), std::runtime_error); // a header cut short
+}
+
+}
@@ -0,0 +1,80 @@
+#include "machine.h"
+#include "../cpu6502/rewind.h"
+
+namespace emulator {
+
+namespace {
+
+// 64 passes over a page, each one writes its own values, about 300000 cycles, stops on the final jump
+const std::vector<uint8_t> program {
+    0xA0, 0x00, // 0400 LDY #0
+    0xA2, 0x00, // 0402 LDX #0
+    0x8A, // 0404 TXA
+    0x65, 0x10, // 0405 ADC $10
+    0x9D, 0x00, 0x20, // 0407 STA $2000,X
+    0x85, 0x10, // 040A STA $10
+    0xE8, // 040C INX
+    0xD0, 0xF5, // 040D BNE $0404
+    0x98, // 040F TYA
+    0x99, 0x00, 0x30, // 0410 STA $3000,Y
+    0xC8, // 0413 INY
+    0xC0, 0x40, // 0414 CPY #$40
+    0xD0, 0xEA, // 0416 BNE $0402
+    0x4C, 0x18, 0x04, // 0418 JMP $0418
+};
+constexpr uint16_t stop = 0x0418;
+
+}
+
+TEST(rewind, seek_matches_a_straight_run)
+{
+    machine recorded { program };
+    rewind_buffer buffer { 10000, 1024 * 1024, 4 };
+    const auto result = buffer.run(recorded.cpu, recorded.bus, stop);
+    EXPECT_EQ(result.reason, cpu6502::stop_reason::address);
+    EXPECT_EQ(buffer.get_first_cycle(), 0);
+    EXPECT_EQ(buffer.size(), recorded.clock.get_cycles() / 10000 + 1);
+
+    // the memory barely changes between snapshots
+    EXPECT_LT(buffer.get_bytes(), buffer.size() * 2048);
+    const size_t last = buffer.get_last_cycle();
+    const size_t size = buffer.size();
+
+    // on a snapshot, between two and past the last one
+    const std::vector<size_t> targets { 250001, 10000, 123456, 40000, 5, 299990 };
+    for (size_t target : targets) {
+        machine straight { program };
+        straight.cpu.run({ .address = stop, .cycles = target });
+        EXPECT_TRUE(buffer.seek(recorded.cpu, recorded.bus, target, stop));
+        expect_same(recorded, straight);
+    }
+
+    // running on after a seek replaces the snapshots after it
+    machine straight { program };
+    straight.cpu.run(stop);
+    EXPECT_TRUE(buffer.seek(recorded.cpu, recorded.bus, 55555, stop));
+    buffer.run(recorded.cpu, recorded.bus, stop);
+    expect_same(recorded, straight);
+    EXPECT_EQ(buffer.get_last_cycle(), last);
+    EXPECT_EQ(buffer.size(), size + 1); // the run captures where it starts
+}
+
+TEST(rewind, budget_drops_the_oldest_group)
+{
+    machine recorded { program };
+    rewind_buffer buffer { 1000, 16 * 1024, 8 };
+    buffer.run(recorded.cpu, recorded.bus, stop);
+    EXPECT_LE(buffer.get_bytes(), 16 * 1024);
+    EXPECT_GT(buffer.get_first_cycle(), 0);
+    EXPECT_LT(buffer.get_first_cycle() % 8000, 10); // a keyframe, within an instruction of every eighth interval
+
+    EXPECT_FALSE(buffer.seek(recorded.cpu, recorded.bus, buffer.get_first_cycle() - 1, stop));
+
+    const size_t target = buffer.get_first_cycle() + 4321;
+    machine straight { program };
+    straight.cpu.run({ .address = stop, .cycles = target });
+    EXPECT_TRUE(buffer.seek(recorded.cpu, recorded.bus, target, stop));
+    expect_same(recorded, straight);
+}
+
+}
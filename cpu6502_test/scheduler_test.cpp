@@ -0,0 +1,182 @@
+#include "machine.h"
+#include "../cpu6502/scheduler.h"
+
+#include <map>
+#include <random>
+
+namespace emulator {
+
+TEST(scheduler, dispatches_in_cycle_order)
+{
+    scheduler events;
+    std::vector<std::pair<int, size_t>> fired;
+    std::vector<scheduler::event_id> ids;
+    for (int i = 0; i < 4; i++)
+        ids.push_back(events.add([&fired, i](size_t cycle) { fired.push_back({ i, cycle }); }));
+
+    events.schedule(ids[0], 300);
+    events.schedule(ids[1], 100);
+    events.schedule(ids[2], 300);
+    events.schedule(ids[3], 200);
+    EXPECT_EQ(events.next_deadline(), 100);
+
+    events.dispatch(99);
+    EXPECT_TRUE(fired.empty());
+
+    events.dispatch(1000);
+    const std::vector<std::pair<int, size_t>> expected { { 1, 100 }, { 3, 200 }, { 0, 300 }, { 2, 300 } };
+    EXPECT_EQ(fired, expected);
+    EXPECT_EQ(events.next_deadline(), scheduler::never);
+}
+
+TEST(scheduler, reschedule_and_cancel)
+{
+    scheduler events;
+    int fired {};
+    const auto a = events.add([&](size_t) { fired++; });
+    const auto b = events.add([&](size_t) { fired += 10; });
+
+    events.schedule(a, 50);
+    events.schedule(b, 60);
+    events.schedule(a, 70);
+    EXPECT_EQ(events.next_deadline(), 60);
+    EXPECT_EQ(events.get_deadline(a), 70);
+
+    events.cancel(b);
+    events.cancel(b);
+    EXPECT_FALSE(events.is_scheduled(b));
+    EXPECT_EQ(events.get_deadline(b), scheduler::never);
+
+    events.dispatch(69);
+    EXPECT_EQ(fired, 0);
+    events.dispatch(70);
+    EXPECT_EQ(fired, 1);
+    EXPECT_FALSE(events.is_scheduled(a));
+}
+
+TEST(scheduler, periodic_handler_catches_up)
+{
+    scheduler events;
+    std::vector<size_t> fired;
+    scheduler::event_id timer {};
+    timer = events.add([&](size_t cycle) {
+        fired.push_back(cycle);
+        events.schedule(timer, cycle + 10);
+    });
+
+    events.schedule(timer, 10);
+    events.dispatch(35);
+    EXPECT_EQ(fired, std::vector<size_t>({ 10, 20, 30 }));
+    EXPECT_EQ(events.next_deadline(), 40);
+}
+
+TEST(scheduler, matches_a_sorted_reference)
+{
+    std::mt19937 random(6502);
+    scheduler events;
+    std::vector<scheduler::event_id> fired;
+    std::vector<size_t> deadlines(64, scheduler::never);
+    for (size_t i = 0; i < deadlines.size(); i++)
+        events.add([&fired, i](size_t) { fired.push_back(i); });
+
+    size_t now = 0;
+    for (int round = 0; round < 2000; round++) {
+        const size_t event = random() % deadlines.size();
+        if (random() % 4 == 0) {
+            events.cancel(event);
+            deadlines[event] = scheduler::never;
+        } else {
+            deadlines[event] = now + random() % 500;
+            events.schedule(event, deadlines[event]);
+        }
+
+        if (round % 8 == 0) {
+            now += random() % 100;
+
+            std::multimap<std::pair<size_t, size_t>, size_t> due;
+            for (size_t i = 0; i < deadlines.size(); i++) {
+                if (deadlines[i] <= now) {
+                    due.insert({ { deadlines[i], i }, i });
+                    deadlines[i] = scheduler::never;
+                }
+            }
+
+            fired.clear();
+            events.dispatch(now);
+            std::vector<scheduler::event_id> expected;
+            for (const auto& [key, event] : due)
+                expected.push_back(event);
+            ASSERT_EQ(fired, expected) << "round " << round;
+        }
+
+        const size_t next = *std::min_element(deadlines.begin(), deadlines.end());
+        ASSERT_EQ(events.next_deadline(), next);
+    }
+}
+
+TEST(scheduler, cpu_stops_at_every_deadline)
+{
+    // 256 * 256 passes over an indexed load that crosses a page for most X, then stops on the JMP
+    const std::vector<uint8_t> program {
+        0xA0, 0x00, // 0400 LDY #0
+        0xA2, 0x00, // 0402 LDX #0
+        0xBD, 0xF0, 0x20, // 0404 LDA $20F0,X
+        0xCA, // 0407 DEX
+        0xD0, 0xFA, // 0408 BNE $0404
+        0x88, // 040A DEY
+        0xD0, 0xF7, // 040B BNE $0404
+        0x4C, 0x0D, 0x04, // 040D JMP $040D
+    };
+
+    for (tier mode : tiers) {
+        machine m { program, mode };
+        scheduler events;
+
+        // every timer checks it runs no later than the instruction in flight at its deadline
+        std::vector<size_t> counts(12);
+        std::vector<scheduler::event_id> timers;
+        for (size_t i = 0; i < counts.size(); i++) {
+            const size_t period = 97 + 131 * i;
+            timers.push_back(events.add([&, i, period](size_t cycle) {
+                EXPECT_LT(m.clock.get_cycles() - cycle, 7u) << "tier " << static_cast<int>(mode);
+                counts[i]++;
+                events.schedule(timers[i], cycle + period);
+            }));
+            events.schedule(timers[i], period);
+        }
+
+        events.run(m.cpu, 0x040D);
+        events.dispatch(m.clock.get_cycles());
+
+        const size_t cycles = m.clock.get_cycles();
+        for (size_t i = 0; i < counts.size(); i++)
+            EXPECT_EQ(counts[i], cycles / (97 + 131 * i)) << "tier " << static_cast<int>(mode) << " timer " << i;
+    }
+}
+
+TEST(scheduler, run_ends_when_the_cpu_jams)
+{
+    emulator::clock clock;
+    memory64k bus;
+    basic_cpu6502<memory64k, emulator::clock> cpu { clock, bus };
+    scheduler events;
+
+    bus.write(0x0400, 0xE8); // INX
+    bus.write(0x0401, 0x4C); // JMP $0400
+    bus.write(0x0402, 0x00);
+    bus.write(0x0403, 0x04);
+    cpu.reset();
+    cpu.PC = 0x0400;
+    cpu.mode = cpu6502::execution_mode::instruction_accurate;
+
+    // the event turns the loop's jump into a JAM
+    const scheduler::event_id jam = events.add([&](size_t) { bus.write(0x0401, 0x02); });
+    events.schedule(jam, 1000);
+
+    const auto result = events.run(cpu, 0x0500);
+    EXPECT_EQ(result.reason, cpu6502::stop_reason::jam);
+    EXPECT_EQ(result.pc, 0x0401);
+    EXPECT_GE(clock.get_cycles(), 1000u);
+}
+
+}
@@ -0,0 +1,66 @@
+#include "../cpu6502/clock.h"
+#include "../cpu6502/cpu6502.h"
+#include "../cpu6502/memory64k.h"
+#include "../cpu6502/trace.h"
+#include "gtest/gtest.h"
+
+namespace emulator {
+
+TEST(trace, ring_keeps_the_newest)
+{
+    trace_ring ring { 5 };
+    EXPECT_EQ(ring.capacity(), 8u);
+    EXPECT_EQ(ring.size(), 0u);
+
+    for (uint64_t cycle = 0; cycle < 10; cycle++)
+        ring.push({ .cycle = cycle, .pc = 0, .address = 0, .oc = 0, .A = 0, .X = 0, .Y = 0, .S = 0, .P = 0, .data = 0, .control = false });
+    ASSERT_EQ(ring.size(), 8u);
+    EXPECT_EQ(ring[0].cycle, 2u);
+    EXPECT_EQ(ring[7].cycle, 9u);
+
+    ring.clear();
+    EXPECT_EQ(ring.size(), 0u);
+}
+
+TEST(trace, records_each_instruction)
+{
+    emulator::clock clock;
+    memory64k bus;
+    basic_cpu6502<memory64k, emulator::clock> cpu { clock, bus };
+    const std::vector<uint8_t> program {
+        0xA2, 0x03, // 0400 LDX #3
+        0xCA, // 0402 DEX
+        0xD0, 0xFD, // 0403 BNE $0402
+        0x8E, 0x00, 0x02, // 0405 STX $0200
+        0x4C, 0x08, 0x04, // 0408 JMP $0408
+    };
+    for (size_t i = 0; i < program.size(); i++)
+        bus.write(static_cast<uint16_t>(0x0400 + i), program[i]);
+    cpu.PC = 0x0400;
+    cpu.mode = cpu6502::execution_mode::instruction_accurate;
+    EXPECT_EQ(cpu.get_trace(), nullptr);
+
+    // blocks step aside while tracing
+    cpu.enable_block_mode(true);
+    cpu.enable_trace(true, 16);
+    cpu.run(0x0408);
+    const trace_ring& trace = *cpu.get_trace();
+    ASSERT_EQ(trace.size(), 9u);
+
+    EXPECT_EQ(trace[0].pc, 0x0400);
+    EXPECT_EQ(trace[0].oc, cpu6502::LDX_IMM);
+    EXPECT_EQ(trace[0].X, 0x03);
+    EXPECT_EQ(trace[0].cycle, 2u);
+    EXPECT_EQ(trace[6].pc, 0x0403);
+    EXPECT_EQ(trace[6].P & 0x02, 0x02); // Z
+    EXPECT_EQ(trace[7].address, 0x0200);
+    EXPECT_FALSE(trace[7].control);
+    EXPECT_EQ(trace[8].pc, 0x0408);
+
+    std::stringstream text;
+    trace.dump(text);
+    EXPECT_EQ(text.str().substr(0, text.str().find('\n')), trace_ring::format(trace[0]));
+    EXPECT_NE(text.str().find("oc: STX"), std::string::npos);
+}
+
+}
@@ -0,0 +1,201 @@
+#include "machine.h"
+#include "../cpu6502/via6522.h"
+
+namespace emulator {
+
+namespace {
+
+    using reg = via6522::reg;
+
+    // a via on a hand-turned clock
+    struct bench {
+        size_t now {};
+        scheduler events;
+        interrupt_lines lines;
+        via6522 via { [this] { return now; }, events, lines };
+
+        uint16_t t1() { return via.read(reg::T1CL) | (via.read(reg::T1CH) << 8); }
+    };
+
+    // a via wired to a cpu
+    struct via_machine : basic_machine<paged_bus> {
+        scheduler events;
+        via6522 via { [this] { return cpu.get_cycles(); }, events, cpu.interrupts };
+
+        via_machine(const std::vector<uint8_t>& program, tier mode)
+            : basic_machine(mode)
+        {
+            bus.load(0x0400, program);
+            bus.load(0xFFFE, { 0x20, 0x04 });
+            bus.map_device(0xD0, 1, via);
+            cpu.reset();
+            cpu.PC = 0x0400;
+            cpu.P.I = 1;
+        }
+    };
+
+}
+
+TEST(via6522, one_shot_t1)
+{
+    bench b;
+    b.via.write(reg::T1CL, 100);
+    b.via.write(reg::T1CH, 0);
+
+    b.now = 60;
+    EXPECT_EQ(b.via.read(reg::T1CH), 0);
+    EXPECT_EQ(b.via.read(reg::T1LL), 100);
+    b.now = 100;
+    EXPECT_EQ(b.via.read(reg::IFR), 0);
+
+    // reaches FFFF and sets the flag once, then keeps counting
+    b.now = 101;
+    EXPECT_EQ(b.via.read(reg::IFR), via6522::irq_t1);
+    EXPECT_EQ(b.t1(), 0xFFFF);
+    EXPECT_EQ(b.via.read(reg::IFR), 0);
+
+    b.now = 101 + 65536 + 10;
+    EXPECT_EQ(b.via.read(reg::IFR), 0);
+    EXPECT_FALSE(b.lines.irq());
+}
+
+TEST(via6522, free_run_t1)
+{
+    bench b;
+    b.via.write(reg::ACR, via6522::acr_t1_free_run);
+    b.via.write(reg::T1CL, 10);
+    b.via.write(reg::T1CH, 0);
+
+    // 10 .. 0, FFFF, then 10 again
+    std::vector<uint16_t> seen;
+    for (b.now = 0; b.now < 14; b.now++)
+        seen.push_back(b.t1());
+    const std::vector<uint16_t> expected { 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 0xFFFF, 10, 9 };
+    EXPECT_EQ(seen, expected);
+
+    // a big jump lands on the same phase
+    b.now = 12 * 1000 + 3;
+    EXPECT_EQ(b.t1(), 7);
+}
+
+TEST(via6522, irq_scheduled_for_the_underflow)
+{
+    bench b;
+    b.via.write(reg::IER, 0x80 | via6522::irq_t1 | via6522::irq_t2);
+    EXPECT_EQ(b.events.next_deadline(), scheduler::never);
+
+    b.now = 1000;
+    b.via.write(reg::T2CL, 50);
+    b.via.write(reg::T2CH, 0);
+    b.via.write(reg::T1CL, 200);
+    b.via.write(reg::T1CH, 0);
+    EXPECT_EQ(b.events.next_deadline(), 1051);
+
+    b.now = 1053;
+    b.events.dispatch(b.now);
+    EXPECT_TRUE(b.lines.irq());
+    EXPECT_EQ(b.via.read(reg::IFR), 0x80 | via6522::irq_t2);
+    EXPECT_EQ(b.events.next_deadline(), 1201);
+
+    // acknowledging T2 drops the line until T1 runs out
+    b.via.read(reg::T2CL);
+    EXPECT_FALSE(b.lines.irq());
+
+    b.via.write(reg::IER, via6522::irq_t1);
+    EXPECT_EQ(b.via.read(reg::IER), 0x80 | via6522::irq_t2);
+    EXPECT_EQ(b.events.next_deadline(), scheduler::never);
+}
+
+TEST(via6522, ports)
+{
+    bench b;
+    b.via.write(reg::DDRA, 0x0F);
+    b.via.write(reg::ORA, 0x55);
+    b.via.set_port_a(0x30);
+    EXPECT_EQ(b.via.read(reg::ORA), 0x35);
+    EXPECT_EQ(b.via.get_port_a(), 0x35);
+    EXPECT_EQ(b.via.read(reg::ORB), 0xFF);
+}
+
+TEST(via6522, timer_irq_in_every_execution_mode)
+{
+    // T1 free-runs at 1000 cycles, the handler counts interrupts and samples T1 while the main loop spins
+    const std::vector<uint8_t> program {
+        0xA9, 0xE6, // 0400 LDA #<998
+        0x8D, 0x04, 0xD0, // 0402 STA T1CL
+        0xA9, 0x03, // 0405 LDA #>998
+        0x8D, 0x05, 0xD0, // 0407 STA T1CH
+        0xA9, 0x40, // 040A LDA #$40
+        0x8D, 0x0B, 0xD0, // 040C STA ACR
+        0xA9, 0xC0, // 040F LDA #$C0
+        0x8D, 0x0E, 0xD0, // 0411 STA IER
+        0x58, // 0414 CLI
+        0xA5, 0x10, // 0415 LDA $10
+        0xC9, 0x40, // 0417 CMP #64
+        0xD0, 0xFA, // 0419 BNE $0415
+        0x4C, 0x1B, 0x04, // 041B JMP $041B
+        0x00, 0x00,
+        0xAD, 0x04, 0xD0, // 0420 LDA T1CL
+        0xA6, 0x10, // 0423 LDX $10
+        0x9D, 0x00, 0x03, // 0425 STA $0300,X
+        0xE6, 0x10, // 0428 INC $10
+        0x40, // 042A RTI
+    };
+
+    std::vector<std::unique_ptr<via_machine>> runs;
+    for (tier mode : tiers) {
+        auto& m = *runs.emplace_back(std::make_unique<via_machine>(program, mode));
+        m.events.run(m.cpu, 0x041B);
+    }
+
+    for (auto& m : runs) {
+        EXPECT_EQ(m->bus.read(0x0010), 64);
+        EXPECT_EQ(m->clock.get_cycles(), runs[0]->clock.get_cycles());
+        for (uint16_t i = 0; i < 64; i++)
+            EXPECT_EQ(m->bus.read(0x0300 + i), runs[0]->bus.read(0x0300 + i)) << "sample " << i;
+    }
+
+    // 64 periods of 1000 cycles after the setup
+    EXPECT_GT(runs[0]->clock.get_cycles(), 64000u);
+    EXPECT_LT(runs[0]->clock.get_cycles(), 65000u);
+
+    // the wait loop only reads RAM, blocks skip most of it
+    for (tier mode : tiers) {
+        const size_t idle = runs[static_cast<size_t>(mode)]->cpu.get_idle_cycles();
+        if (mode == tier::blocks || mode == tier::jit)
+            EXPECT_GT(idle, 60000u);
+        else
+            EXPECT_EQ(idle, 0u);
+    }
+}
+
+TEST(via6522, polling_a_register_is_not_idle)
+{
+    // waits on IFR for a one-shot T2 with IRQ masked, the flag comes up without the cpu writing anything
+    const std::vector<uint8_t> program {
+        0xA9, 0xA0, // 0400 LDA #$A0
+        0x8D, 0x0E, 0xD0, // 0402 STA IER
+        0xA9, 0x00, // 0405 LDA #<5000
+        0x8D, 0x08, 0xD0, // 0407 STA T2CL
+        0xA9, 0x14, // 040A LDA #>5000
+        0x8D, 0x09, 0xD0, // 040C STA T2CH
+        0xAD, 0x0D, 0xD0, // 040F LDA IFR
+        0x29, 0x20, // 0412 AND #$20
+        0xF0, 0xF9, // 0414 BEQ $040F
+        0x4C, 0x16, 0x04, // 0416 JMP $0416
+    };
+
+    std::vector<std::unique_ptr<via_machine>> runs;
+    for (tier mode : tiers) {
+        auto& m = *runs.emplace_back(std::make_unique<via_machine>(program, mode));
+        m.events.run(m.cpu, 0x0416);
+    }
+
+    for (auto& m : runs) {
+        EXPECT_EQ(m->cpu.get_idle_cycles(), 0u);
+        EXPECT_EQ(m->clock.get_cycles(), runs[0]->clock.get_cycles());
+    }
+    EXPECT_GT(runs[0]->clock.get_cycles(), 5120u);
+}
+
+}
@@ -0,0 +1,104 @@
+#include "machine.h"
+#include "../cpu6502/write_journal.h"
+
+namespace emulator {
+
+namespace {
+
+    void expect_entry(const write_journal::entry& write, size_t cycle, uint16_t pc, uint16_t address, uint8_t old, uint8_t value)
+    {
+        EXPECT_EQ(write.cycle, cycle);
+        EXPECT_EQ(write.pc, pc);
+        EXPECT_EQ(write.address, address);
+        EXPECT_EQ(write.old, old);
+        EXPECT_EQ(write.value, value);
+    }
+
+}
+
+TEST(write_journal, records_who_wrote)
+{
+    machine m { {
+        0xA9, 0x11, // 0400 LDA #$11
+        0x8D, 0x42, 0x03, // 0402 STA $0342
+        0x20, 0x10, 0x04, // 0405 JSR $0410
+        0xEE, 0x42, 0x03, // 0408 INC $0342
+        0x4C, 0x0B, 0x04, // 040B JMP $040B
+        0x00, 0x00,
+        0xA9, 0x22, // 0410 LDA #$22
+        0x8D, 0x42, 0x03, // 0412 STA $0342
+        0x60, // 0415 RTS
+    } };
+    EXPECT_EQ(m.cpu.get_write_journal(), nullptr);
+
+    m.cpu.enable_write_journal(true);
+    m.cpu.run(0x040B);
+    const write_journal& journal = *m.cpu.get_write_journal();
+    ASSERT_EQ(journal.size(), 6u);
+
+    expect_entry(journal[0], 2, 0x0402, 0x0342, 0x00, 0x11);
+    expect_entry(journal[1], 6, 0x0405, 0x01FD, 0x00, 0x04); // the return address, high byte first
+    expect_entry(journal[2], 6, 0x0405, 0x01FC, 0x00, 0x07);
+    expect_entry(journal[3], 14, 0x0412, 0x0342, 0x11, 0x22);
+    expect_entry(journal[4], 24, 0x0408, 0x0342, 0x22, 0x22); // read-modify-write stores the old byte first
+    expect_entry(journal[5], 24, 0x0408, 0x0342, 0x22, 0x23);
+
+    // who wrote $0342 before the INC
+    const auto last = journal.last_write(0x0342, 24);
+    ASSERT_TRUE(last);
+    EXPECT_EQ(last->pc, 0x0412);
+    EXPECT_FALSE(journal.last_write(0x0342, 2));
+    EXPECT_EQ(journal.writes(0x0342, 0, 24).size(), 2u);
+    EXPECT_EQ(journal.writes(6, 15).size(), 3u);
+
+    m.cpu.enable_write_journal(false);
+    EXPECT_EQ(m.cpu.get_write_journal(), nullptr);
+}
+
+TEST(write_journal, queries_over_many_chunks)
+{
+    // every tenth cycle, the address cycles through 256 bytes
+    write_journal journal;
+    for (size_t i = 0; i < 100000; i++)
+        journal.record({ i * 10, 0x0400, static_cast<uint16_t>(0x2000 + (i & 0xFF)), 0, static_cast<uint8_t>(i >> 8) });
+
+    const auto last = journal.last_write(0x2005, 500000);
+    ASSERT_TRUE(last);
+    EXPECT_EQ(last->cycle, (49920 + 5) * 10u);
+    EXPECT_FALSE(journal.last_write(0x2005, 50));
+    EXPECT_FALSE(journal.last_write(0x3000, 1000000));
+
+    EXPECT_EQ(journal.writes(0x2005, 0, 1000000).size(), 391u);
+    EXPECT_EQ(journal.writes(0x2005, 50, 2611).size(), 2u);
+    const auto range = journal.writes(123455, 123505);
+    ASSERT_EQ(range.size(), 5u);
+    EXPECT_EQ(range.front().cycle, 123460u);
+
+    journal.clear();
+    EXPECT_EQ(journal.size(), 0u);
+    EXPECT_FALSE(journal.last_write(0x2005, 500000));
+}
+
+TEST(write_journal, jit_stores_are_journaled)
+{
+    machine m { {
+        0xA2, 0x00, // 0400 LDX #0
+        0x8A, // 0402 TXA
+        0x9D, 0x00, 0x20, // 0403 STA $2000,X
+        0xCA, // 0406 DEX
+        0xD0, 0xF9, // 0407 BNE $0402
+        0x4C, 0x09, 0x04, // 0409 JMP $0409
+    } };
+    if (!m.cpu.enable_jit(true))
+        GTEST_SKIP() << "no x86-64 host";
+
+    m.cpu.enable_write_journal(true);
+    m.cpu.run(0x0409);
+    const write_journal& journal = *m.cpu.get_write_journal();
+    ASSERT_EQ(journal.size(), 256u);
+    for (size_t i = 0; i < journal.size(); i++)
+        EXPECT_EQ(journal[i].pc, 0x0403);
+    EXPECT_EQ(journal.last_write(0x20FF, 1000000)->value, 0xFF);
+}
+
+}
@@ -0,0 +1,94 @@
+#include "../cpu6502/clock.h"
+#include "../cpu6502/cpu6502.h"
+#include "../cpu6502/mappers.h"
+#include "../cpu6502/paged_bus.h"
+#include "benchmarks.h"
+
+namespace {
+
+using cpu_t = emulator::basic_cpu6502<emulator::paged_bus, emulator::clock>;
+
+constexpr size_t banks = 16;
+constexpr uint16_t stop = 0xC013;
+constexpr size_t repeats = 8;
+
+// banks 0-7 hold a small routine at $8000, the fixed last bank a driver that
+// switches to bank X & 7 and calls it, 65536 times
+std::vector<uint8_t> make_image()
+{
+    std::vector<uint8_t> rom(banks * emulator::uxrom_mapper::bank_size, 0xEA);
+
+    for (size_t bank = 0; bank < 8; bank++) {
+        const std::vector<uint8_t> routine {
+            0x18, // 8000 CLC
+            0x69, static_cast<uint8_t>(bank), // 8001 ADC #bank
+            0x85, 0x10, // 8003 STA $10
+            0x60, // 8005 RTS
+        };
+        std::copy(routine.begin(), routine.end(), rom.begin() + bank * emulator::uxrom_mapper::bank_size);
+    }
+
+    const std::vector<uint8_t> driver {
+        0xA0, 0x00, // C000 LDY #0
+        0xA2, 0x00, // C002 LDX #0
+        0x8A, // C004 TXA
+        0x29, 0x07, // C005 AND #7
+        0x8D, 0x00, 0x80, // C007 STA $8000
+        0x20, 0x00, 0x80, // C00A JSR $8000
+        0xE8, // C00D INX
+        0xD0, 0xF4, // C00E BNE $C004
+        0x88, // C010 DEY
+        0xD0, 0xF1, // C011 BNE $C004
+        0x4C, 0x13, 0xC0, // C013 JMP $C013
+    };
+    std::copy(driver.begin(), driver.end(), rom.begin() + (banks - 1) * emulator::uxrom_mapper::bank_size);
+
+    return rom;
+}
+
+void measure(const char* name, const std::vector<uint8_t>& image, void (*setup)(cpu_t&, bool&))
+{
+    emulator::clock clock;
+    emulator::paged_bus bus;
+    emulator::uxrom_mapper mapper(bus, image);
+    cpu_t cpu { clock, bus };
+    cpu.reset();
+
+    bool available = true;
+    setup(cpu, available);
+    if (!available) {
+        std::cout << name << ": unavailable\n";
+        return;
+    }
+
+    clock.set_timing(0);
+    cpu.mode = emulator::cpu6502::execution_mode::instruction_accurate;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeats; i++) {
+        cpu.PC = 0xC000;
+        cpu.address = 0xC000;
+        cpu.run(stop);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double elapsed_seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << name << ": " << elapsed_seconds << " s"
+              << " cycles: " << clock.get_cycles()
+              << " bank switches: " << mapper.get_switches()
+              << " bank switches/s: " << static_cast<size_t>(mapper.get_switches() / elapsed_seconds)
+              << " cycles/s: " << static_cast<size_t>(clock.get_cycles() / elapsed_seconds)
+              << '\n';
+}
+
+}
+
+void bank_switch_benchmark()
+{
+    const auto image = make_image();
+
+    measure("interpreter", image, [](cpu_t&, bool&) {});
+    measure("decode cache", image, [](cpu_t& cpu, bool&) { cpu.enable_decode_cache(true); });
+    measure("block mode", image, [](cpu_t& cpu, bool&) { cpu.enable_block_mode(true); });
+    measure("jit", image, [](cpu_t& cpu, bool& available) { available = cpu.enable_jit(true); });
+}
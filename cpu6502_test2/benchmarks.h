@@ -0,0 +1,7 @@
+#pragma once
+
+// extra benchmarks picked by a command line switch in main.cpp
+void bank_switch_benchmark();
+void scheduler_benchmark();
+void savestate_benchmark();
+void replay_benchmark();
@@ -1,26 +1,65 @@
 #include "../cpu6502/clock.h"
 #include "../cpu6502/cpu6502.h"
 #include "../cpu6502/memory64k.h"
+#include "benchmarks.h"
 
 int main(int argc, char** argv)
 {
-    using oc = emulator::cpu6502::opcode;
+    if (argc > 1 && std::string_view(argv[1]) == "--bank-switch") {
+        bank_switch_benchmark();
+        return 0;
+    }
+
+    if (argc > 1 && std::string_view(argv[1]) == "--scheduler") {
+        scheduler_benchmark();
+        return 0;
+    }
+
+    if (argc > 1 && std::string_view(argv[1]) == "--savestate") {
+        savestate_benchmark();
+        return 0;
+    }
+
+    if (argc > 1 && std::string_view(argv[1]) == "--replay") {
+        replay_benchmark();
+        return 0;
+    }
 
     emulator::clock clock;
     emulator::memory64k bus;
-    emulator::cpu6502 cpu { clock, bus };
+    emulator::basic_cpu6502<emulator::memory64k, emulator::clock> cpu { clock, bus };
 
-    bus.load_file("C:/Users/rafal/Source/cpu6502/docs/6502_65C02_functional_tests-master/6502_functional_test.bin");
+    std::string filepath = (argc > 1)
+        ? argv[1]
+        : "C:/Users/rafal/Source/cpu6502/docs/6502_65C02_functional_tests-master/6502_functional_test.bin";
+
+    // --bigrams prints the most frequent opcode pairs after the run
+    bool report_bigrams = argc > 2 && std::string_view(argv[2]) == "--bigrams";
+
+    bus.load_file(filepath);
     clock.set_timing(0);
     cpu.PC = 0x0400;
+    cpu.enable_bigram_profile(report_bigrams);
 
+    size_t instructions {};
     auto start = std::chrono::steady_clock::now();
 
-    cpu.run(0x3699);
+    while (cpu.address != 0x3699) {
+        cpu.execute();
+        instructions++;
+    }
+    std::cout << emulator::trace_ring::format(cpu.trace_state(cpu.PC)) << '\n';
 
     auto end = std::chrono::steady_clock::now();
     double elapsed_seconds = std::chrono::duration_cast<
         std::chrono::duration<double>>(end - start)
                                  .count();
     std::cout << elapsed_seconds << '\n';
-}
\ No newline at end of file
+    std::cout << "instructions: " << instructions
+              << " cycles: " << clock.get_cycles()
+              << " instructions/s: " << static_cast<size_t>(instructions / elapsed_seconds)
+              << '\n';
+
+    if (report_bigrams)
+        cpu.report_bigrams();
+}
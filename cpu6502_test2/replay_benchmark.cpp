@@ -0,0 +1,125 @@
+#include "../cpu6502/clock.h"
+#include "../cpu6502/cpu6502.h"
+#include "../cpu6502/paged_bus.h"
+#include "../cpu6502/replay.h"
+#include "../cpu6502/via6522.h"
+#include "benchmarks.h"
+
+namespace {
+
+using cpu_t = emulator::basic_cpu6502<emulator::paged_bus, emulator::clock>;
+
+constexpr uint16_t stop = 0x042A;
+
+// 16 * 256 * 256 passes over a small loop body, T1 interrupts every 500 cycles,
+// the handler adds port A to a sum
+const std::vector<uint8_t> program {
+    0xA9, 0xF2, // 0400 LDA #<498
+    0x8D, 0x04, 0xD0, // 0402 STA T1CL
+    0xA9, 0x01, // 0405 LDA #>498
+    0x8D, 0x05, 0xD0, // 0407 STA T1CH
+    0xA9, 0x40, // 040A LDA #$40
+    0x8D, 0x0B, 0xD0, // 040C STA ACR
+    0xA9, 0xC0, // 040F LDA #$C0
+    0x8D, 0x0E, 0xD0, // 0411 STA IER
+    0xA9, 0x10, // 0414 LDA #16
+    0x85, 0x10, // 0416 STA $10
+    0x58, // 0418 CLI
+    0xA0, 0x00, // 0419 LDY #0
+    0xA2, 0x00, // 041B LDX #0
+    0xBD, 0x00, 0x20, // 041D LDA $2000,X
+    0xCA, // 0420 DEX
+    0xD0, 0xFA, // 0421 BNE $041D
+    0x88, // 0423 DEY
+    0xD0, 0xF7, // 0424 BNE $041D
+    0xC6, 0x10, // 0426 DEC $10
+    0xD0, 0xF3, // 0428 BNE $041D
+    0x4C, 0x2A, 0x04, // 042A JMP $042A
+    0x00, 0x00, 0x00,
+    0x48, // 0430 PHA
+    0xAD, 0x04, 0xD0, // 0431 LDA T1CL
+    0xAD, 0x01, 0xD0, // 0434 LDA ORA
+    0x18, // 0437 CLC
+    0x65, 0x20, // 0438 ADC $20
+    0x85, 0x20, // 043A STA $20
+    0x68, // 043C PLA
+    0x40, // 043D RTI
+};
+
+struct machine {
+    emulator::clock clock;
+    emulator::paged_bus bus;
+    cpu_t cpu { clock, bus };
+
+    machine(void (*setup)(cpu_t&, bool&), bool& available)
+    {
+        bus.load(0x0400, program);
+        bus.load(0xFFFE, { 0x30, 0x04 });
+        cpu.reset();
+        cpu.PC = 0x0400;
+        cpu.P.I = 1;
+        cpu.mode = emulator::cpu6502::execution_mode::instruction_accurate;
+        clock.set_timing(0);
+        setup(cpu, available);
+    }
+};
+
+void report(const char* name, const char* part, double elapsed_seconds, size_t cycles)
+{
+    std::cout << name << ' ' << part << ": " << elapsed_seconds << " s"
+              << " cycles/s: " << static_cast<size_t>(cycles / elapsed_seconds)
+              << '\n';
+}
+
+// the recorded run with the VIA and its events, then the replay from the same start without them
+void measure(const char* name, void (*setup)(cpu_t&, bool&))
+{
+    bool available = true;
+    machine recorded { setup, available };
+    if (!available) {
+        std::cout << name << ": unavailable\n";
+        return;
+    }
+
+    emulator::scheduler events;
+    emulator::via6522 via { [&] { return recorded.cpu.get_cycles(); }, events, recorded.cpu.interrupts };
+    via.set_port_a(0x5A);
+    auto recorder = std::make_unique<emulator::input_recorder>(
+        recorded.cpu.interrupts, [&] { return recorded.cpu.get_cycles(); });
+    recorded.bus.map_device(0xD0, 1, recorder->tap(via));
+
+    const emulator::cpu6502::cpu_state state = recorded.cpu.save();
+    auto image = std::make_unique<emulator::memory_image>();
+    recorded.bus.snapshot(*image);
+
+    auto start = std::chrono::steady_clock::now();
+    events.run(recorded.cpu, stop);
+    auto end = std::chrono::steady_clock::now();
+    report(name, "recorded", std::chrono::duration<double>(end - start).count(), recorded.clock.get_cycles());
+
+    const std::vector<uint8_t> log = recorder->get_log();
+    recorder.reset();
+
+    machine replayed { setup, available };
+    replayed.bus.restore(*image);
+    replayed.cpu.restore(state);
+    emulator::input_player player { log, replayed.cpu.interrupts, [&] { return replayed.cpu.get_cycles(); } };
+    replayed.bus.map_device(0xD0, 1, player);
+
+    start = std::chrono::steady_clock::now();
+    player.run(replayed.cpu, stop);
+    end = std::chrono::steady_clock::now();
+    report(name, "replayed", std::chrono::duration<double>(end - start).count(), replayed.clock.get_cycles());
+
+    const bool same = emulator::state_hash(recorded.cpu, recorded.bus) == emulator::state_hash(replayed.cpu, replayed.bus);
+    std::cout << name << " log: " << log.size() << " bytes, final state " << (same ? "matches" : "differs") << '\n';
+}
+
+}
+
+void replay_benchmark()
+{
+    measure("interpreter", [](cpu_t&, bool&) {});
+    measure("block mode", [](cpu_t& cpu, bool&) { cpu.enable_block_mode(true); });
+    measure("jit", [](cpu_t& cpu, bool& available) { available = cpu.enable_jit(true); });
+}
@@ -0,0 +1,130 @@
+#include "../cpu6502/clock.h"
+#include "../cpu6502/cpu6502.h"
+#include "../cpu6502/memory64k.h"
+#include "benchmarks.h"
+
+namespace {
+
+using cpu_t = emulator::basic_cpu6502<emulator::memory64k, emulator::clock>;
+
+constexpr size_t repeats = 20000;
+
+// the fields a checkpoint had to pick one by one before cpu_state
+struct scattered_state {
+    size_t cycles;
+    uint16_t PC;
+    uint16_t address;
+    uint8_t A;
+    uint8_t X;
+    uint8_t Y;
+    uint8_t S;
+    emulator::cpu6502::status P;
+    uint8_t oc;
+    uint8_t data;
+    bool control;
+    emulator::memory_image memory;
+};
+
+struct machine {
+    emulator::clock clock;
+    emulator::memory64k bus;
+    cpu_t cpu { clock, bus };
+
+    machine()
+    {
+        for (size_t i = 0; i < 64 * 1024; i++)
+            bus.write(static_cast<uint16_t>(i), static_cast<uint8_t>(i * 7));
+        cpu.reset();
+        clock.set_timing(0);
+    }
+};
+
+void report(const char* name, double elapsed_seconds)
+{
+    std::cout << name << ": " << elapsed_seconds * 1e9 / repeats << " ns per copy\n";
+}
+
+template <typename Body>
+void measure(const char* name, Body body)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeats; i++)
+        body(i);
+    auto end = std::chrono::steady_clock::now();
+
+    report(name, std::chrono::duration<double>(end - start).count());
+}
+
+}
+
+void savestate_benchmark()
+{
+    machine m;
+    emulator::i_bus* volatile bus = &m.bus; // keeps the reads virtual
+    auto scattered = std::make_unique<scattered_state>();
+    auto image = std::make_unique<emulator::memory_image>();
+    auto copy = std::make_unique<emulator::memory_image>();
+    emulator::cpu6502::cpu_state state {};
+
+    measure("memcpy alone", [&](size_t i) {
+        (*image)[i & 0xFFFF] = static_cast<uint8_t>(i);
+        *copy = *image;
+    });
+
+    measure("save field by field", [&](size_t) {
+        scattered->cycles = m.clock.get_cycles();
+        scattered->PC = m.cpu.PC;
+        scattered->address = m.cpu.address;
+        scattered->A = m.cpu.A;
+        scattered->X = m.cpu.X;
+        scattered->Y = m.cpu.Y;
+        scattered->S = m.cpu.S;
+        scattered->P = m.cpu.P;
+        scattered->oc = m.cpu.oc;
+        scattered->data = m.cpu.data;
+        scattered->control = m.cpu.control;
+        for (size_t address = 0; address < scattered->memory.size(); address++)
+            scattered->memory[address] = bus->read(static_cast<uint16_t>(address));
+    });
+
+    measure("save", [&](size_t i) {
+        m.cpu.A = static_cast<uint8_t>(i);
+        state = m.cpu.save();
+        m.bus.snapshot(*image);
+    });
+
+    measure("restore", [&](size_t) {
+        m.cpu.restore(state);
+        m.bus.restore(*image);
+    });
+
+    // a run that only touches zero page, the stack and one data page
+    m.bus.set_baseline();
+    measure("reset to baseline, 3 dirty pages", [&](size_t i) {
+        m.bus.write(0x0010, static_cast<uint8_t>(i));
+        m.bus.write(0x01FF, static_cast<uint8_t>(i));
+        m.bus.write(0x2000, static_cast<uint8_t>(i));
+        m.bus.reset_to_baseline();
+    });
+
+    emulator::memory64k::page_snapshot pages;
+    measure("incremental snapshot and restore, 3 dirty pages", [&](size_t i) {
+        m.bus.write(0x0010, static_cast<uint8_t>(i));
+        m.bus.write(0x01FF, static_cast<uint8_t>(i));
+        m.bus.write(0x2000, static_cast<uint8_t>(i));
+        m.bus.snapshot_dirty(pages);
+        m.bus.restore(pages);
+    });
+
+    // the cpu part alone, no memory
+    volatile uint8_t sink {};
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeats * 100; i++) {
+        m.cpu.A = static_cast<uint8_t>(i);
+        state = m.cpu.save();
+        m.cpu.restore(state);
+        sink = m.cpu.A;
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "cpu save + restore: " << std::chrono::duration<double>(end - start).count() * 1e9 / (repeats * 100) << " ns\n";
+}
@@ -0,0 +1,131 @@
+#include "../cpu6502/clock.h"
+#include "../cpu6502/cpu6502.h"
+#include "../cpu6502/memory64k.h"
+#include "../cpu6502/scheduler.h"
+#include "benchmarks.h"
+
+namespace {
+
+using cpu_t = emulator::basic_cpu6502<emulator::memory64k, emulator::clock>;
+
+constexpr uint16_t stop = 0x0415;
+constexpr size_t timers = 16;
+
+// 16 * 256 * 256 passes over a small loop body
+const std::vector<uint8_t> program {
+    0xA9, 0x10, // 0400 LDA #16
+    0x85, 0x10, // 0402 STA $10
+    0xA0, 0x00, // 0404 LDY #0
+    0xA2, 0x00, // 0406 LDX #0
+    0xBD, 0x00, 0x20, // 0408 LDA $2000,X
+    0xCA, // 040B DEX
+    0xD0, 0xFA, // 040C BNE $0408
+    0x88, // 040E DEY
+    0xD0, 0xF7, // 040F BNE $0408
+    0xC6, 0x10, // 0411 DEC $10
+    0xD0, 0xF3, // 0413 BNE $0408
+    0x4C, 0x15, 0x04, // 0415 JMP $0415
+};
+
+size_t period(size_t timer)
+{
+    return 200 + 331 * timer;
+}
+
+struct machine {
+    emulator::clock clock;
+    emulator::memory64k bus;
+    cpu_t cpu { clock, bus };
+
+    machine()
+    {
+        for (size_t i = 0; i < program.size(); i++)
+            bus.write(static_cast<uint16_t>(0x0400 + i), program[i]);
+        cpu.reset();
+        cpu.PC = 0x0400;
+        cpu.mode = emulator::cpu6502::execution_mode::instruction_accurate;
+        clock.set_timing(0);
+    }
+};
+
+void report(const char* name, double elapsed_seconds, size_t cycles, size_t events)
+{
+    std::cout << name << ": " << elapsed_seconds << " s"
+              << " cycles: " << cycles
+              << " events: " << events
+              << " cycles/s: " << static_cast<size_t>(cycles / elapsed_seconds)
+              << '\n';
+}
+
+// the old way, every timer counts down after each instruction
+void measure_ticked()
+{
+    machine m;
+    std::array<size_t, timers> remaining;
+    for (size_t i = 0; i < timers; i++)
+        remaining[i] = period(i);
+    size_t events {};
+
+    auto start = std::chrono::steady_clock::now();
+    size_t last = 0;
+    while (m.cpu.address != stop) {
+        m.cpu.execute();
+        const size_t now = m.clock.get_cycles();
+        const size_t elapsed = now - last;
+        last = now;
+        for (size_t i = 0; i < timers; i++) {
+            if (remaining[i] > elapsed) {
+                remaining[i] -= elapsed;
+                continue;
+            }
+            remaining[i] += period(i) - elapsed;
+            events++;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    report("ticked interpreter", std::chrono::duration<double>(end - start).count(), m.clock.get_cycles(), events);
+}
+
+// every timer reschedules itself, every fourth one also pushes back a watchdog that never fires
+void measure_scheduled(const char* name, void (*setup)(cpu_t&, bool&))
+{
+    machine m;
+    bool available = true;
+    setup(m.cpu, available);
+    if (!available) {
+        std::cout << name << ": unavailable\n";
+        return;
+    }
+
+    emulator::scheduler events;
+    size_t fired {};
+    const auto watchdog = events.add([](size_t) {});
+    std::array<emulator::scheduler::event_id, timers> ids;
+    for (size_t i = 0; i < timers; i++) {
+        ids[i] = events.add([&, i](size_t cycle) {
+            fired++;
+            events.schedule(ids[i], cycle + period(i));
+            if (i % 4 == 0)
+                events.schedule(watchdog, cycle + 100000);
+        });
+        events.schedule(ids[i], period(i));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    events.run(m.cpu, stop);
+    auto end = std::chrono::steady_clock::now();
+
+    report(name, std::chrono::duration<double>(end - start).count(), m.clock.get_cycles(), fired);
+}
+
+}
+
+void scheduler_benchmark()
+{
+    measure_ticked();
+    measure_scheduled("scheduled interpreter", [](cpu_t&, bool&) {});
+    measure_scheduled("scheduled decode cache", [](cpu_t& cpu, bool&) { cpu.enable_decode_cache(true); });
+    measure_scheduled("scheduled block mode", [](cpu_t& cpu, bool&) { cpu.enable_block_mode(true); });
+    measure_scheduled("scheduled jit", [](cpu_t& cpu, bool& available) { available = cpu.enable_jit(true); });
+}